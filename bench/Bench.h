@@ -0,0 +1,52 @@
+#pragma once
+#include "TSP.h"
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+// Function that makes count random locations spread over a box about the size of Los Angeles.
+std::vector<Location> MakeRandomLocations(size_t count, unsigned seed);
+
+// Function that runs f once and returns the wall time in seconds.
+template <typename F>
+double TimeSeconds(F&& f)
+{
+	auto start = std::chrono::steady_clock::now();
+	f();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+// Function that returns the length of the greedy nearest-neighbor tour from location 0, a simple reference for targets.
+double NearestNeighborLength(const std::vector<Location>& locations);
+
+// Result of running the genetic algorithm until the best tour is no longer than a target length
+struct TargetRun
+{
+	int mGenerations = 0;
+	double mSeconds = 0.0;
+	double mBest = 0.0;
+	bool mReached = false;
+};
+
+// Function that runs the genetic algorithm with the given options until the best tour reaches target or maxGenerations pass.
+TargetRun RunToTarget(const std::vector<Location>& locations, const GAOptions& options, int popSize, int maxGenerations, int mutationChance, int seed, double target);
+
+// The benchmarks, run by name from BenchMain.cpp
+void BenchCrossover();
+void BenchOperators();
+void BenchEax();
+void BenchGreedy();
+void BenchMutation();
+void BenchSeeding();
+void BenchHilbert();
+void BenchConstruction();
+void BenchInitialPopulation();
+void BenchKdTree();
+void BenchDelaunay();
+void BenchClusters();
+void BenchParse();
+void BenchTspLib();
+void BenchMemetic();
+void BenchTwoLevel();
+void BenchRng();
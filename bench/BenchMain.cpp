@@ -0,0 +1,133 @@
+// BenchMain.cpp : Runs the benchmarks named on the command line (or all of them).
+// Build with RELEASE=ON for meaningful numbers.
+
+#include "Bench.h"
+#include "Distance.h"
+#include "Diversity.h"
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+
+std::vector<Location> MakeRandomLocations(size_t count, unsigned seed)
+{
+	std::mt19937 generator(seed);
+	std::uniform_real_distribution<double> latitude(33.7, 34.3);
+	std::uniform_real_distribution<double> longitude(-118.7, -117.9);
+	std::vector<Location> locations(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		locations[i].mName = "City " + std::to_string(i);
+		locations[i].mLatitude = latitude(generator);
+		locations[i].mLongitude = longitude(generator);
+	}
+	return locations;
+}
+
+double NearestNeighborLength(const std::vector<Location>& locations)
+{
+	std::vector<bool> visited(locations.size(), false);
+	visited[0] = true;
+	int current = 0;
+	double length = 0.0;
+	for (size_t step = 1; step < locations.size(); step++)
+	{
+		int next = -1;
+		double nextDistance = 0.0;
+		for (size_t i = 0; i < locations.size(); i++)
+		{
+			double distance = GetHaversineDistance(locations[current].mLongitude, locations[current].mLatitude, locations[i].mLongitude, locations[i].mLatitude);
+			if (!visited[i] && (next < 0 || distance < nextDistance))
+			{
+				next = static_cast<int>(i);
+				nextDistance = distance;
+			}
+		}
+		visited[next] = true;
+		length += nextDistance;
+		current = next;
+	}
+	return length + GetHaversineDistance(locations[current].mLongitude, locations[current].mLatitude, locations[0].mLongitude, locations[0].mLatitude);
+}
+
+TargetRun RunToTarget(const std::vector<Location>& locations, const GAOptions& options, int popSize, int maxGenerations, int mutationChance, int seed, double target)
+{
+	TargetRun run;
+	ThreadPool pool(options.mThreads);
+	std::mt19937 generator(seed);
+	DistanceStore distances(locations);
+	if (NeedsCandidates(options))
+	{
+		distances.BuildCandidates(options.mCandidates, options.mCandidateSet);
+	}
+	auto start = std::chrono::steady_clock::now();
+
+	Population pop = options.mParallelInit
+		? ParallelFillInitialPopulation(popSize, seed, locations, distances, options.mInitialTours, pool)
+		: FillInitialPopulation(popSize, generator, locations, distances, options.mInitialTours);
+	SeedInitialPopulation(pop, generator, distances, options.mSeeding, options.mSeedingFraction);
+	std::vector<std::pair<int,int>> selections;
+	DiversityScratch diversityScratch;
+	for (int genNumber = 1; genNumber <= maxGenerations; genNumber++)
+	{
+		std::vector<std::pair<int,double>> fitnesses = computeFitnesses(pop, locations);
+		run.mBest = std::min_element(fitnesses.begin(), fitnesses.end(), [](const std::pair<int,double>& a, const std::pair<int,double>& b) {
+			return a.second < b.second;
+		})->second;
+		run.mGenerations = genNumber - 1;
+		if (run.mBest <= target)
+		{
+			run.mReached = true;
+			break;
+		}
+		if (options.mAdaptiveMutation)
+		{
+			mutationChance = AdaptMutationChance(MeasureDiversity(pop, diversityScratch), popSize, mutationChance, options);
+		}
+		pop = NextGeneration(fitnesses, pop, locations, generator, seed, genNumber, popSize, mutationChance, options, distances, pool, selections);
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	run.mSeconds = elapsed.count();
+	return run;
+}
+
+int main(int argc, const char* argv[])
+{
+	const std::vector<std::pair<std::string, std::function<void()>>> benchmarks = {
+		{ "crossover", BenchCrossover },
+		{ "operators", BenchOperators },
+		{ "eax", BenchEax },
+		{ "greedy", BenchGreedy },
+		{ "mutation", BenchMutation },
+		{ "seeding", BenchSeeding },
+		{ "hilbert", BenchHilbert },
+		{ "construction", BenchConstruction },
+		{ "init", BenchInitialPopulation },
+		{ "kdtree", BenchKdTree },
+		{ "delaunay", BenchDelaunay },
+		{ "clusters", BenchClusters },
+		{ "parse", BenchParse },
+		{ "tsplib", BenchTspLib },
+		{ "memetic", BenchMemetic },
+		{ "twolevel", BenchTwoLevel },
+		{ "rng", BenchRng },
+	};
+
+	for (const auto& bench : benchmarks)
+	{
+		bool selected = argc < 2;
+		for (int i = 1; i < argc; i++)
+		{
+			selected = selected || bench.first == argv[i];
+		}
+		if (selected)
+		{
+			std::cout << "== " << bench.first << " ==" << std::endl;
+			bench.second();
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,42 @@
+#include "Bench.h"
+#include "Clusters.h"
+#include "Construction.h"
+#include "Distance.h"
+#include "LocalSearch.h"
+#include <iostream>
+#include <random>
+
+// Runs the cluster solver on 10,000 to 200,000 cities, with a small genetic algorithm (greedy crossover and 2-opt, then a
+// Lin-Kernighan polish of the best tour) on clusters of 1,000, against a nearest-neighbor tour and a single
+// Lin-Kernighan search over the whole instance. Reports the seconds, the tour length relative to the nearest-neighbor
+// tour, and the seconds per thousand cities.
+void BenchClusters()
+{
+	std::cout << "cities	solver	seconds	length/nearest neighbor	seconds per 1000 cities" << std::endl;
+	for (size_t cities : { 10000, 50000, 200000 })
+	{
+		std::vector<Location> locations = MakeRandomLocations(cities, 1337);
+		DistanceStore distances(locations);
+		distances.BuildCandidates(8);
+		ConstructionScratch constructionScratch;
+		std::vector<int> nearest;
+		NearestNeighborTour(distances, 0, constructionScratch, nearest);
+		double reference = distances.TourLength(nearest);
+
+		std::vector<int> tour = nearest;
+		LocalSearchScratch scratch;
+		double seconds = TimeSeconds([&]() { LinKernighan(tour, distances, 0, scratch); });
+		std::cout << cities << '\t' << "lin-kernighan" << '\t' << seconds << '\t' << distances.TourLength(tour) / reference << '\t' << seconds * 1000 / cities << std::endl;
+
+		GAOptions options;
+		options.mSolver = SolverMode::Clusters;
+		options.mClusterSize = 1000;
+		options.mCrossover = CrossoverMode::Greedy;
+		options.mLocalSearch = LocalSearchMode::TwoOpt;
+		options.mInitialTours = InitialTourMode::Hilbert;
+		options.mPolish = true;
+		ThreadPool pool(options.mThreads);
+		seconds = TimeSeconds([&]() { tour = SolveByClusters<std::mt19937>(locations, distances, 16, 10, 10, 1337, options, pool); });
+		std::cout << cities << '\t' << "clusters" << '\t' << seconds << '\t' << distances.TourLength(tour) / reference << '\t' << seconds * 1000 / cities << std::endl;
+	}
+}
@@ -0,0 +1,139 @@
+#include "Bench.h"
+#include "Construction.h"
+#include "Distance.h"
+#include <functional>
+#include <iostream>
+#include <string>
+
+// Reports tour quality and wall time after a fixed number of generations when the initial population is random or has
+// 10% nearest-neighbor or greedy edge tours, for the splice and greedy crossovers.
+void BenchSeeding()
+{
+	const int popSize = 100;
+	const std::vector<std::pair<const char*, CrossoverMode>> operators = {
+		{ "splice", CrossoverMode::Splice },
+		{ "greedy", CrossoverMode::Greedy },
+	};
+	const std::vector<std::pair<const char*, SeedingMode>> seedings = {
+		{ "random", SeedingMode::Random },
+		{ "nn", SeedingMode::NearestNeighbor },
+		{ "greedy", SeedingMode::GreedyEdge },
+	};
+
+	std::cout << "cities	operator	seeding	generations	seconds	best/nearest neighbor" << std::endl;
+	for (size_t cities : { 1000, 5000 })
+	{
+		std::vector<Location> locations = MakeRandomLocations(cities, 1337);
+		double reference = NearestNeighborLength(locations);
+		for (const auto& op : operators)
+		{
+			for (const auto& seeding : seedings)
+			{
+				for (int generations : { 0, 100 })
+				{
+					GAOptions options;
+					options.mCrossover = op.second;
+					options.mSeeding = seeding.second;
+					TargetRun run = RunToTarget(locations, options, popSize, generations + 1, 10, 1337, 0.0);
+					std::cout << cities << '\t' << op.first << '\t' << seeding.first << '\t' << generations << '\t' << run.mSeconds << '\t' << run.mBest / reference << std::endl;
+				}
+			}
+		}
+	}
+}
+
+// Reports the wall time and tour length of the Hilbert curve order, plain and shifted, from 1,000 to 1,000,000 cities.
+// Up to 10,000 cities it also builds the candidate lists and the nearest-neighbor and greedy edge tours as a
+// reference; their times do not include the candidate lists.
+void BenchHilbert()
+{
+	std::cout << "cities	construction	seconds	length	length/nearest neighbor" << std::endl;
+	for (size_t cities : { 1000, 10000, 100000, 1000000 })
+	{
+		std::vector<Location> locations = MakeRandomLocations(cities, 1337);
+		DistanceStore distances(locations);
+		ConstructionScratch scratch;
+		std::vector<int> tour;
+		double reference = 0.0;
+		if (cities <= 10000)
+		{
+			double seconds = TimeSeconds([&]() { distances.BuildCandidates(10); });
+			std::cout << cities << '\t' << "candidate lists" << '\t' << seconds << '\t' << '-' << '\t' << '-' << std::endl;
+			seconds = TimeSeconds([&]() { NearestNeighborTour(distances, 0, scratch, tour); });
+			reference = distances.TourLength(tour);
+			std::cout << cities << '\t' << "nearest neighbor" << '\t' << seconds << '\t' << reference << '\t' << 1.0 << std::endl;
+			seconds = TimeSeconds([&]() { GreedyEdgeTour(distances, 0.0, 0, scratch, tour); });
+			std::cout << cities << '\t' << "greedy edge" << '\t' << seconds << '\t' << distances.TourLength(tour) << '\t' << distances.TourLength(tour) / reference << std::endl;
+		}
+
+		std::vector<ProjectedPoint> points;
+		double seconds = TimeSeconds([&]() {
+			points = ProjectLocations(locations);
+			HilbertTour(points, 0.0, 0, scratch, tour);
+		});
+		double length = distances.TourLength(tour);
+		std::cout << cities << '\t' << "hilbert" << '\t' << seconds << '\t' << length << '\t' << (reference > 0.0 ? std::to_string(length / reference) : "-") << std::endl;
+		seconds = TimeSeconds([&]() { HilbertTour(points, 1.0, 42, scratch, tour); });
+		length = distances.TourLength(tour);
+		std::cout << cities << '\t' << "hilbert shifted" << '\t' << seconds << '\t' << length << '\t' << (reference > 0.0 ? std::to_string(length / reference) : "-") << std::endl;
+	}
+}
+
+// Reports the wall time and tour length of every construction heuristic on 1,000, 10,000 and 100,000 cities, relative to
+// the nearest-neighbor tour. The candidate lists (10 per city) are timed on their own row.
+void BenchConstruction()
+{
+	std::cout << "cities	construction	seconds	length	length/nearest neighbor" << std::endl;
+	for (size_t cities : { 1000, 10000, 100000 })
+	{
+		std::vector<Location> locations = MakeRandomLocations(cities, 1337);
+		DistanceStore distances(locations);
+		std::vector<ProjectedPoint> points = ProjectLocations(locations);
+		ConstructionScratch scratch;
+		std::vector<int> tour;
+		double seconds = TimeSeconds([&]() { distances.BuildCandidates(10); });
+		std::cout << cities << '\t' << "candidate lists" << '\t' << seconds << '\t' << '-' << '\t' << '-' << std::endl;
+
+		const std::vector<std::pair<const char*, std::function<void()>>> methods = {
+			{ "nearest neighbor", [&]() { NearestNeighborTour(distances, 0, scratch, tour); } },
+			{ "greedy edge", [&]() { GreedyEdgeTour(distances, 0.0, 0, scratch, tour); } },
+			{ "hilbert", [&]() { HilbertTour(points, 0.0, 0, scratch, tour); } },
+			{ "cheapest insertion", [&]() { CheapestInsertionTour(distances, 0.0, 0, scratch, tour); } },
+			{ "farthest insertion", [&]() { FarthestInsertionTour(distances, points, 0.0, 0, scratch, tour); } },
+			{ "convex hull insertion", [&]() { ConvexHullInsertionTour(distances, points, 0.0, 0, scratch, tour); } },
+			{ "christofides", [&]() { ChristofidesTour(distances, 0.0, 0, scratch, tour); } },
+		};
+		double reference = 0.0;
+		for (const auto& method : methods)
+		{
+			seconds = TimeSeconds(method.second);
+			double length = distances.TourLength(tour);
+			if (reference == 0.0)
+			{
+				reference = length;
+			}
+			std::cout << cities << '\t' << method.first << '\t' << seconds << '\t' << length << '\t' << length / reference << std::endl;
+		}
+	}
+}
+
+// Reports the wall time of the random initial population of 10,000 members over 10,000 cities, drawn one member after
+// another from a single generator versus on the thread pool with one stream per member.
+void BenchInitialPopulation()
+{
+	const int popSize = 10000;
+	const size_t cities = 10000;
+	std::vector<Location> locations = MakeRandomLocations(cities, 1337);
+	DistanceStore distances(locations);
+
+	std::cout << "members	cities	method	threads	seconds" << std::endl;
+	std::mt19937 generator(1337);
+	double seconds = TimeSeconds([&]() { FillInitialPopulation(popSize, generator, cities); });
+	std::cout << popSize << '\t' << cities << '\t' << "sequential" << '\t' << 1 << '\t' << seconds << std::endl;
+	for (int threads : { 1, 2, 4, 0 })
+	{
+		ThreadPool pool(threads);
+		seconds = TimeSeconds([&]() { ParallelFillInitialPopulation(popSize, 1337, locations, distances, InitialTourMode::Shuffle, pool); });
+		std::cout << popSize << '\t' << cities << '\t' << "parallel" << '\t' << pool.GetThreadCount() << '\t' << seconds << std::endl;
+	}
+}
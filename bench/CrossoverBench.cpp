@@ -0,0 +1,216 @@
+#include "Bench.h"
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <random>
+
+// The child construction Crossover used before the visited set: a std::find over the partial child for every gene of the
+// second parent. It draws the same random numbers in the same order, so its children must match Crossover's exactly.
+static Population FindCrossover(const std::vector<std::pair<int,int>>& selections, std::mt19937& generator, const Population& currentPop, int mutationChanceInt)
+{
+	Population returnPop;
+	for (const auto& parents : selections)
+	{
+		size_t locationSize = currentPop.mMembers[parents.first].size();
+		std::uniform_int_distribution<int> distribution(1, locationSize - 2);
+		int crossoverIndex = distribution(generator);
+		std::uniform_int_distribution<int> binaryOut(0, 1);
+		bool swapParents = binaryOut(generator) == 0;
+		const std::vector<int>& first = currentPop.mMembers[swapParents ? parents.second : parents.first];
+		const std::vector<int>& second = currentPop.mMembers[swapParents ? parents.first : parents.second];
+
+		std::vector<int> newMem;
+		std::copy_n(first.begin(), crossoverIndex + 1, std::back_inserter(newMem));
+		std::copy_if(second.begin(), second.end(), std::back_inserter(newMem), [&newMem](const int& i) {
+			return std::find(newMem.begin(), newMem.end(), i) == newMem.end();
+		});
+
+		std::uniform_real_distribution<double> mutation;
+		if (mutation(generator) <= mutationChanceInt / 100.0)
+		{
+			std::uniform_int_distribution<int> mutationSwap(1, newMem.size() - 1);
+			int randomFirstIndex = mutationSwap(generator);
+			int randomSecondIndex = mutationSwap(generator);
+			std::swap(newMem[randomFirstIndex], newMem[randomSecondIndex]);
+		}
+		returnPop.mMembers.push_back(newMem);
+	}
+	return returnPop;
+}
+
+// Compares child construction with std::find against the visited set as the number of cities grows.
+void BenchCrossover()
+{
+	const int popSize = 64;
+	std::cout << "cities\tfind us/child\tvisited us/child\tspeedup\tidentical" << std::endl;
+	for (size_t cities : { 100, 250, 500, 1000, 2500, 5000, 10000 })
+	{
+		std::vector<Location> locations = MakeRandomLocations(cities, 1337);
+		std::mt19937 generator(1337);
+		Population pop = FillInitialPopulation(popSize, generator, cities);
+		std::vector<std::pair<int,int>> selections(popSize);
+		std::uniform_int_distribution<int> member(0, popSize - 1);
+		for (auto& parents : selections)
+		{
+			parents = std::make_pair(member(generator), member(generator));
+		}
+
+		// The std::find version gets slow quickly, so give it fewer children on big instances.
+		std::vector<std::pair<int,int>> findSelections(selections.begin(), selections.begin() + (cities > 2500 ? 8 : popSize));
+
+		Population viaFind;
+		Population viaVisited;
+		std::mt19937 findGenerator(42);
+		double findSeconds = TimeSeconds([&]() { viaFind = FindCrossover(findSelections, findGenerator, pop, 10); });
+		std::mt19937 visitedGenerator(42);
+		double visitedSeconds = TimeSeconds([&]() { viaVisited = Crossover(selections, locations, visitedGenerator, popSize, pop, 10); });
+
+		double findPerChild = findSeconds * 1e6 / findSelections.size();
+		double visitedPerChild = visitedSeconds * 1e6 / selections.size();
+		bool identical = std::equal(viaFind.mMembers.begin(), viaFind.mMembers.end(), viaVisited.mMembers.begin());
+		std::cout << cities << '\t' << findPerChild << '\t' << visitedPerChild << '\t' << findPerChild / visitedPerChild << "x\t" << (identical ? "yes" : "NO") << std::endl;
+	}
+}
+
+// Reports generations and wall time until the best tour is as short as the nearest-neighbor tour, per crossover operator,
+// with both the rank roulette and the tournament selection.
+void BenchOperators()
+{
+	const int popSize = 200;
+	const int maxGenerations = 3000;
+	const std::vector<std::pair<const char*, CrossoverMode>> operators = {
+		{ "splice", CrossoverMode::Splice },
+		{ "ox1", CrossoverMode::Order },
+		{ "pmx", CrossoverMode::PartiallyMapped },
+		{ "eax", CrossoverMode::EdgeAssembly },
+		{ "eax-local", CrossoverMode::EdgeAssemblyLocal },
+		{ "greedy", CrossoverMode::Greedy },
+	};
+	const std::vector<std::pair<const char*, SelectionMode>> selections = {
+		{ "roulette", SelectionMode::Roulette },
+		{ "tournament", SelectionMode::Tournament },
+	};
+
+	std::cout << "cities\tselection\toperator\tgenerations\tseconds\tbest/target" << std::endl;
+	for (size_t cities : { 50, 100, 200 })
+	{
+		std::vector<Location> locations = MakeRandomLocations(cities, 1337);
+		double target = NearestNeighborLength(locations);
+		for (const auto& selection : selections)
+		{
+			for (const auto& op : operators)
+			{
+				GAOptions options;
+				options.mSelection = selection.second;
+				options.mCrossover = op.second;
+				TargetRun run = RunToTarget(locations, options, popSize, maxGenerations, 10, 1337, target);
+				std::cout << cities << '\t' << selection.first << '\t' << op.first << '\t' << (run.mReached ? std::to_string(run.mGenerations) : "not reached") << '\t'
+					<< run.mSeconds << '\t' << run.mBest / target << std::endl;
+			}
+		}
+	}
+}
+
+// Reports tour quality over time on bigger instances with a small population, for OX1 and both EAX strategies.
+void BenchEax()
+{
+	const int popSize = 30;
+	const std::vector<std::pair<const char*, CrossoverMode>> operators = {
+		{ "ox1", CrossoverMode::Order },
+		{ "eax", CrossoverMode::EdgeAssembly },
+		{ "eax-local", CrossoverMode::EdgeAssemblyLocal },
+	};
+
+	std::cout << "cities\toperator\tgenerations\tseconds\tbest/nearest neighbor" << std::endl;
+	for (size_t cities : { 1000, 5000 })
+	{
+		std::vector<Location> locations = MakeRandomLocations(cities, 1337);
+		double reference = NearestNeighborLength(locations);
+		for (const auto& op : operators)
+		{
+			for (int generations : { 50, 200 })
+			{
+				GAOptions options;
+				options.mSelection = SelectionMode::Tournament;
+				options.mCrossover = op.second;
+				TargetRun run = RunToTarget(locations, options, popSize, generations, 10, 1337, 0.0);
+				std::cout << cities << '\t' << op.first << '\t' << generations << '\t' << run.mSeconds << '\t' << run.mBest / reference << std::endl;
+			}
+		}
+	}
+}
+
+// Reports the wall time until the best tour is within a factor of the nearest-neighbor tour, for the original splice
+// and greedy crossover with the default roulette selection.
+void BenchGreedy()
+{
+	const int popSize = 100;
+	const int maxGenerations = 1000;
+	const std::vector<std::pair<const char*, CrossoverMode>> operators = {
+		{ "splice", CrossoverMode::Splice },
+		{ "greedy", CrossoverMode::Greedy },
+	};
+
+	std::cout << "cities	operator	target/nearest neighbor	generations	seconds	best/nearest neighbor" << std::endl;
+	for (size_t cities : { 200, 1000 })
+	{
+		std::vector<Location> locations = MakeRandomLocations(cities, 1337);
+		double reference = NearestNeighborLength(locations);
+		for (const auto& op : operators)
+		{
+			for (double factor : { 4.0, 2.0, 1.5, 1.25 })
+			{
+				GAOptions options;
+				options.mCrossover = op.second;
+				TargetRun run = RunToTarget(locations, options, popSize, maxGenerations, 10, 1337, factor * reference);
+				std::cout << cities << '\t' << op.first << '\t' << factor << '\t' << (run.mReached ? std::to_string(run.mGenerations) : "not reached") << '\t'
+					<< run.mSeconds << '\t' << run.mBest / reference << std::endl;
+			}
+		}
+	}
+}
+
+// Reports tour quality and wall time after a fixed number of generations with swap versus inversion mutation, for the
+// splice and greedy crossovers at a 30% mutation chance, fixed or steered by the population's diversity.
+void BenchMutation()
+{
+	const int popSize = 100;
+	const std::vector<std::pair<const char*, CrossoverMode>> operators = {
+		{ "splice", CrossoverMode::Splice },
+		{ "greedy", CrossoverMode::Greedy },
+	};
+	struct Mutation
+	{
+		const char* mName;
+		MutationMode mMode;
+		bool mAdaptive;
+	};
+	const std::vector<Mutation> mutations = {
+		{ "swap", MutationMode::Swap, false },
+		{ "inversion", MutationMode::Inversion, false },
+		{ "swap adaptive", MutationMode::Swap, true },
+		{ "inversion adaptive", MutationMode::Inversion, true },
+	};
+
+	std::cout << "cities	operator	mutation	generations	seconds	best/nearest neighbor" << std::endl;
+	for (size_t cities : { 200, 1000 })
+	{
+		std::vector<Location> locations = MakeRandomLocations(cities, 1337);
+		double reference = NearestNeighborLength(locations);
+		for (const auto& op : operators)
+		{
+			for (const auto& mutation : mutations)
+			{
+				for (int generations : { 100, 500 })
+				{
+					GAOptions options;
+					options.mCrossover = op.second;
+					options.mMutation = mutation.mMode;
+					options.mAdaptiveMutation = mutation.mAdaptive;
+					TargetRun run = RunToTarget(locations, options, popSize, generations, 30, 1337, 0.0);
+					std::cout << cities << '\t' << op.first << '\t' << mutation.mName << '\t' << generations << '\t' << run.mSeconds << '\t' << run.mBest / reference << std::endl;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,133 @@
+#include "Bench.h"
+#include "Distance.h"
+#include "LocalSearch.h"
+#include "TwoLevelTour.h"
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+
+// Reports tour quality and wall time after a fixed number of generations, for the pure genetic algorithm and with the
+// 2-opt memetic stage on every child, on the shortest tenth of the children, and with a budget of moves per generation,
+// and with Or-opt, 2-opt plus Or-opt and the Lin-Kernighan search on the shortest tenth.
+void BenchMemetic()
+{
+	const int popSize = 50;
+	struct Config
+	{
+		const char* mName;
+		CrossoverMode mCrossover;
+		LocalSearchMode mLocalSearch;
+		double mFraction;
+		int mBudget;
+	};
+	const std::vector<Config> configs = {
+		{ "splice", CrossoverMode::Splice, LocalSearchMode::None, 1.0, 0 },
+		{ "greedy", CrossoverMode::Greedy, LocalSearchMode::None, 1.0, 0 },
+		{ "splice+2opt all", CrossoverMode::Splice, LocalSearchMode::TwoOpt, 1.0, 0 },
+		{ "splice+2opt elite", CrossoverMode::Splice, LocalSearchMode::TwoOpt, 0.1, 0 },
+		{ "greedy+2opt all", CrossoverMode::Greedy, LocalSearchMode::TwoOpt, 1.0, 0 },
+		{ "greedy+2opt elite", CrossoverMode::Greedy, LocalSearchMode::TwoOpt, 0.1, 0 },
+		{ "greedy+2opt budget", CrossoverMode::Greedy, LocalSearchMode::TwoOpt, 1.0, 5000 },
+		{ "greedy+oropt elite", CrossoverMode::Greedy, LocalSearchMode::OrOpt, 0.1, 0 },
+		{ "greedy+2opt+oropt elite", CrossoverMode::Greedy, LocalSearchMode::TwoOptOrOpt, 0.1, 0 },
+		{ "greedy+lk elite", CrossoverMode::Greedy, LocalSearchMode::LinKernighan, 0.1, 0 },
+	};
+
+	std::cout << "cities\tconfig\tgenerations\tseconds\tbest/nearest neighbor" << std::endl;
+	for (size_t cities : { 1000, 2500 })
+	{
+		std::vector<Location> locations = MakeRandomLocations(cities, 1337);
+		double reference = NearestNeighborLength(locations);
+		for (const auto& config : configs)
+		{
+			for (int generations : { 10, 50 })
+			{
+				GAOptions options;
+				options.mCrossover = config.mCrossover;
+				options.mLocalSearch = config.mLocalSearch;
+				options.mLocalSearchFraction = config.mFraction;
+				options.mLocalSearchBudget = config.mBudget;
+				TargetRun run = RunToTarget(locations, options, popSize, generations, 10, 1337, 0.0);
+				std::cout << cities << '\t' << config.mName << '\t' << generations << '\t' << run.mSeconds << '\t' << run.mBest / reference << std::endl;
+			}
+		}
+	}
+}
+
+// Compares the flat array tour with the two-level list: the cost of random path reversals (each one reverses the shorter
+// side, as the local search does) and the wall time of 2-opt plus Or-opt from a random tour on each representation.
+void BenchTwoLevel()
+{
+	std::cout << "cities\treversals\tarray seconds\tlist seconds" << std::endl;
+	for (int cities : { 1000, 10000, 100000 })
+	{
+		const int reversals = 10000;
+		std::mt19937 generator(1337);
+		std::vector<int> tour = FillInitialPopulation(1, generator, cities).mMembers[0];
+		std::vector<std::pair<int,int>> paths(reversals);
+		std::uniform_int_distribution<int> city(0, cities - 1);
+		for (auto& path : paths)
+		{
+			path = { city(generator), city(generator) };
+		}
+
+		std::vector<int> array = tour;
+		std::vector<int> positions(cities);
+		for (int i = 0; i < cities; i++)
+		{
+			positions[array[i]] = i;
+		}
+		double arraySeconds = TimeSeconds([&]() {
+			for (const auto& path : paths)
+			{
+				int begin = positions[path.first];
+				int end = positions[path.second];
+				int length = (end - begin + cities) % cities + 1;
+				if (2 * length > cities)
+				{
+					begin = (end + 1) % cities;
+					end = (positions[path.first] + cities - 1) % cities;
+					length = cities - length;
+				}
+				for (int step = 0; step < length / 2; step++)
+				{
+					std::swap(array[begin], array[end]);
+					positions[array[begin]] = begin;
+					positions[array[end]] = end;
+					begin = begin + 1 == cities ? 0 : begin + 1;
+					end = end == 0 ? cities - 1 : end - 1;
+				}
+			}
+		});
+
+		TwoLevelTour list;
+		list.Assign(tour);
+		double listSeconds = TimeSeconds([&]() {
+			for (const auto& path : paths)
+			{
+				list.Reverse(path.first, path.second);
+			}
+		});
+		std::cout << cities << '\t' << reversals << '\t' << arraySeconds << '\t' << listSeconds << std::endl;
+	}
+
+	std::cout << "cities\trepresentation\tseconds\tlength/nearest neighbor" << std::endl;
+	for (int cities : { 1000, 5000, 10000 })
+	{
+		std::vector<Location> locations = MakeRandomLocations(cities, 1337);
+		double reference = NearestNeighborLength(locations);
+		DistanceStore distances(locations);
+		distances.BuildCandidates(8);
+		std::mt19937 generator(1337);
+		std::vector<int> start = FillInitialPopulation(1, generator, cities).mMembers[0];
+		for (bool useList : { false, true })
+		{
+			LocalSearchScratch scratch;
+			scratch.mTwoLevelFrom = useList ? 0 : start.size() + 1;
+			std::vector<int> tour = start;
+			double seconds = TimeSeconds([&]() { TwoOptOrOpt(tour, distances, 0, scratch); });
+			std::cout << cities << '\t' << (useList ? "two-level list" : "array") << '\t' << seconds << '\t' << distances.TourLength(tour) / reference << std::endl;
+		}
+	}
+}
@@ -0,0 +1,169 @@
+#include "Bench.h"
+#include "LocationFile.h"
+#include "Parallel.h"
+#include "TspLib.h"
+#include "Construction.h"
+#include "LocalSearch.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+
+// Function that reads the file the way ReadLocations used to: getline, then substr, erase and stod per field.
+static size_t ReadWithStreams(const std::string& fileName)
+{
+	std::ifstream in(fileName);
+	std::string line;
+	std::vector<Location> locations;
+	while (std::getline(in, line))
+	{
+		size_t comma = line.find(',');
+		Location location;
+		location.mName = line.substr(0, comma);
+		line.erase(0, comma + 1);
+		comma = line.find(',');
+		location.mLatitude = std::stod(line.substr(0, comma));
+		line.erase(0, comma + 1);
+		comma = line.find(',');
+		location.mLongitude = std::stod(line.substr(0, comma));
+		locations.push_back(location);
+	}
+	return locations.size();
+}
+
+// Writes a file of 10,000,000 "name,latitude,longitude" lines (about 540 MB) and reports how fast it is read: the
+// memory-mapped scan alone, ReadLocations (the scan plus a copy of every name), the old stream-based reading, and the
+// chunked parsing and reading on 1 to 8 threads. The file is read once beforehand so every reader finds it in the page
+// cache.
+void BenchParse()
+{
+	const std::string fileName = "bench_locations.txt";
+	const size_t lines = 10000000;
+	{
+		std::mt19937 generator(1337);
+		std::uniform_real_distribution<double> latitude(33.7, 34.3);
+		std::uniform_real_distribution<double> longitude(-118.7, -117.9);
+		std::ofstream out(fileName, std::ios::binary);
+		char buffer[128];
+		for (size_t i = 0; i < lines; i++)
+		{
+			int length = std::snprintf(buffer, sizeof(buffer), "%zu Main Street Los Angeles,%.6f,%.6f\n", i, latitude(generator), longitude(generator));
+			out.write(buffer, length);
+		}
+	}
+
+	MappedFile file(fileName);
+	double gigabytes = file.Text().size() / 1e9;
+	size_t warm = 0;
+	for (char c : file.Text())
+	{
+		warm += c == '\n';
+	}
+	std::cout << "lines	bytes	reader	seconds	GB/s" << std::endl;
+
+	std::vector<LocationRecord> records;
+	records.reserve(lines);
+	double seconds = TimeSeconds([&]() { ParseLocations(file.Text(), records); });
+	std::cout << records.size() << '\t' << file.Text().size() << '\t' << "mmap + from_chars" << '\t' << seconds << '\t' << gigabytes / seconds << std::endl;
+
+	std::vector<Location> locations;
+	seconds = TimeSeconds([&]() { locations = ReadLocations(fileName); });
+	std::cout << locations.size() << '\t' << file.Text().size() << '\t' << "ReadLocations" << '\t' << seconds << '\t' << gigabytes / seconds << std::endl;
+	locations = std::vector<Location>();
+
+	size_t count = 0;
+	seconds = TimeSeconds([&]() { count = ReadWithStreams(fileName); });
+	std::cout << count << '\t' << file.Text().size() << '\t' << "getline + stod" << '\t' << seconds << '\t' << gigabytes / seconds << std::endl;
+
+	// The chunked parsing on the thread pool, for growing thread counts (0 is one thread per core)
+	for (int threads : { 1, 2, 4, 8, 0 })
+	{
+		ThreadPool pool(threads);
+		std::vector<std::vector<LocationRecord>> chunks;
+		seconds = TimeSeconds([&]() { ParallelParseLocations(file.Text(), pool, chunks); });
+		count = 0;
+		for (const auto& chunk : chunks)
+		{
+			count += chunk.size();
+		}
+		std::string name = "parallel parse, " + std::to_string(pool.GetThreadCount()) + " threads";
+		std::cout << count << '\t' << file.Text().size() << '\t' << name << '\t' << seconds << '\t' << gigabytes / seconds << std::endl;
+		chunks = std::vector<std::vector<LocationRecord>>();
+
+		seconds = TimeSeconds([&]() { locations = ReadLocations(fileName, pool); });
+		name = "ReadLocations, " + std::to_string(pool.GetThreadCount()) + " threads";
+		std::cout << locations.size() << '\t' << file.Text().size() << '\t' << name << '\t' << seconds << '\t' << gigabytes / seconds << std::endl;
+		locations = std::vector<Location>();
+	}
+
+	if (warm != lines)
+	{
+		std::cout << "unexpected line count " << warm << std::endl;
+	}
+	std::remove(fileName.c_str());
+}
+
+// Reads generated TSPLIB files, 1,000,000 EUC_2D nodes and a 3,000-node UPPER_ROW matrix, with their distance stores
+// (without candidate lists), and runs Lin-Kernighan on burma14 against its published optimum of 3323.
+void BenchTspLib()
+{
+	std::cout << "instance	bytes	seconds	GB/s	length/optimum" << std::endl;
+	const std::string fileName = "bench_instance.tsp";
+	std::mt19937 generator(1337);
+	std::uniform_int_distribution<int> coordinate(0, 1000000);
+	{
+		std::ofstream out(fileName, std::ios::binary);
+		out << "NAME: random1M\nTYPE: TSP\nDIMENSION: 1000000\nEDGE_WEIGHT_TYPE: EUC_2D\nNODE_COORD_SECTION\n";
+		for (int i = 1; i <= 1000000; i++)
+		{
+			out << i << ' ' << coordinate(generator) << ' ' << coordinate(generator) << '\n';
+		}
+		out << "EOF\n";
+	}
+	size_t bytes = MappedFile(fileName).Text().size();
+	double seconds = TimeSeconds([&]() {
+		TspLibInstance instance = ReadTspLib(fileName);
+		DistanceStore distances = MakeDistanceStore(instance);
+	});
+	std::cout << "EUC_2D, 1000000 nodes" << '\t' << bytes << '\t' << seconds << '\t' << bytes / 1e9 / seconds << '\t' << '-' << std::endl;
+
+	{
+		std::ofstream out(fileName, std::ios::binary);
+		out << "NAME: random3000\nTYPE: TSP\nDIMENSION: 3000\nEDGE_WEIGHT_TYPE: EXPLICIT\nEDGE_WEIGHT_FORMAT: UPPER_ROW\nEDGE_WEIGHT_SECTION\n";
+		for (int i = 0; i < 3000; i++)
+		{
+			for (int j = i + 1; j < 3000; j++)
+			{
+				out << coordinate(generator) << (j + 1 < 3000 ? ' ' : '\n');
+			}
+		}
+		out << "EOF\n";
+	}
+	bytes = MappedFile(fileName).Text().size();
+	seconds = TimeSeconds([&]() {
+		TspLibInstance instance = ReadTspLib(fileName);
+		DistanceStore distances = MakeDistanceStore(instance);
+	});
+	std::cout << "UPPER_ROW, 3000 nodes" << '\t' << bytes << '\t' << seconds << '\t' << bytes / 1e9 / seconds << '\t' << '-' << std::endl;
+
+	{
+		std::ofstream out(fileName, std::ios::binary);
+		out << "NAME: burma14\nTYPE: TSP\nDIMENSION: 14\nEDGE_WEIGHT_TYPE: GEO\nNODE_COORD_SECTION\n"
+			<< "1 16.47 96.10\n2 16.47 94.44\n3 20.09 92.54\n4 22.39 93.37\n5 25.23 97.24\n6 22.00 96.05\n7 20.47 97.02\n"
+			<< "8 17.20 96.29\n9 16.30 97.38\n10 14.05 98.12\n11 16.53 97.38\n12 21.52 95.59\n13 19.41 97.13\n14 20.09 94.55\nEOF\n";
+	}
+	bytes = MappedFile(fileName).Text().size();
+	TspLibInstance burma = ReadTspLib(fileName);
+	DistanceStore distances = MakeDistanceStore(burma);
+	distances.BuildCandidates(8);
+	std::vector<int> tour;
+	seconds = TimeSeconds([&]() {
+		ConstructionScratch constructionScratch;
+		NearestNeighborTour(distances, 0, constructionScratch, tour);
+		LocalSearchScratch scratch;
+		LinKernighan(tour, distances, 0, scratch);
+	});
+	std::cout << "burma14, nearest neighbor + LK" << '\t' << bytes << '\t' << seconds << '\t' << '-' << '\t' << distances.TourLength(tour) / 3323 << std::endl;
+	std::remove(fileName.c_str());
+}
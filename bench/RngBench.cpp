@@ -0,0 +1,83 @@
+#include "Bench.h"
+#include "Distance.h"
+#include <iostream>
+#include <random>
+#include <string>
+
+// Function that finds how many outputs generator has produced since it was seeded like fresh, by searching the fresh
+// stream for the next four outputs of generator.
+template <typename Engine>
+static size_t DrawsMade(Engine generator, Engine fresh)
+{
+	typename Engine::result_type next[4];
+	for (auto& value : next)
+	{
+		value = generator();
+	}
+	typename Engine::result_type window[4];
+	for (auto& value : window)
+	{
+		value = fresh();
+	}
+	size_t position = 0;
+	while (window[0] != next[0] || window[1] != next[1] || window[2] != next[2] || window[3] != next[3])
+	{
+		window[0] = window[1];
+		window[1] = window[2];
+		window[2] = window[3];
+		window[3] = fresh();
+		position++;
+	}
+	return position;
+}
+
+// Function that runs the default genetic algorithm (roulette selection, splice crossover) with the given engine and
+// prints the wall time, the number of engine outputs it used and the share of the run spent producing them.
+template <typename Engine>
+static void RunWithEngine(const std::string& name, const std::vector<Location>& locations, int popSize, int generations, Engine seeded)
+{
+	GAOptions options;
+	ThreadPool pool(1);
+	DistanceStore distances(locations);
+	Engine generator = seeded;
+	std::vector<std::pair<int,int>> selections;
+	double seconds = TimeSeconds([&]() {
+		Population pop = FillInitialPopulation(popSize, generator, locations.size());
+		for (int genNumber = 1; genNumber <= generations; genNumber++)
+		{
+			std::vector<std::pair<int,double>> fitnesses = computeFitnesses(pop, locations);
+			pop = NextGeneration(fitnesses, pop, locations, generator, 1337, genNumber, popSize, 20, options, distances, pool, selections);
+		}
+	});
+
+	// Time the same number of raw engine outputs on their own.
+	size_t draws = DrawsMade(generator, seeded);
+	Engine replay = seeded;
+	typename Engine::result_type sink = 0;
+	double rngSeconds = TimeSeconds([&]() {
+		for (size_t i = 0; i < draws; i++)
+		{
+			sink ^= replay();
+		}
+	});
+	volatile auto keep = sink;
+	(void)keep;
+
+	std::cout << locations.size() << '\t' << name << '\t' << seconds * 1000.0 << '\t' << draws << '\t' << rngSeconds * 1e9 / draws
+		<< '\t' << 100.0 * rngSeconds / seconds << "%" << std::endl;
+}
+
+// Compares the share of the runtime that goes into the random engine for std::mt19937, xoshiro256** and PCG64.
+void BenchRng()
+{
+	const int popSize = 512;
+	const int generations = 50;
+	std::cout << "cities\tengine\tms\tdraws\tns/draw\trng share" << std::endl;
+	for (size_t cities : { 50, 200, 1000 })
+	{
+		std::vector<Location> locations = MakeRandomLocations(cities, 1337);
+		RunWithEngine("mt19937", locations, popSize, generations, std::mt19937(1337));
+		RunWithEngine("xoshiro256**", locations, popSize, generations, Xoshiro256StarStar(1337));
+		RunWithEngine("pcg64", locations, popSize, generations, Pcg64(1337));
+	}
+}
@@ -0,0 +1,140 @@
+#include "Bench.h"
+#include "Construction.h"
+#include "Distance.h"
+#include "KdTree.h"
+#include "LocalSearch.h"
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <tuple>
+
+// Reports the throughput of the KD-tree from 10,000 to 1,000,000 cities: building it, 10-nearest-neighbor queries from
+// every city, radius queries that find about 10 cities each, a nearest-neighbor walk through every city with deletion
+// marks, and the candidate lists built on top of it.
+void BenchKdTree()
+{
+	std::cout << "cities	operation	seconds	per second" << std::endl;
+	for (size_t cities : { 10000, 100000, 1000000 })
+	{
+		std::vector<Location> locations = MakeRandomLocations(cities, 1337);
+		KdTree tree;
+		double seconds = TimeSeconds([&]() { tree = KdTree(locations); });
+		std::cout << cities << '\t' << "build" << '\t' << seconds << '\t' << cities / seconds << std::endl;
+
+		std::vector<std::pair<double,int>> nearest;
+		size_t found = 0;
+		seconds = TimeSeconds([&]() {
+			for (size_t city = 0; city < cities; city++)
+			{
+				tree.Nearest(static_cast<int>(city), 10, nearest);
+				found += nearest.size();
+			}
+		});
+		std::cout << cities << '\t' << "10 nearest" << '\t' << seconds << '\t' << cities / seconds << std::endl;
+
+		// The radius that holds 10 other cities around city 0, in miles
+		tree.Nearest(0, 10, nearest);
+		double miles = 3961 * 2 * std::asin(std::sqrt(nearest.back().first) / 2);
+		std::vector<int> within;
+		seconds = TimeSeconds([&]() {
+			for (size_t city = 0; city < cities; city++)
+			{
+				tree.WithinRadius(static_cast<int>(city), miles, within);
+				found += within.size();
+			}
+		});
+		std::cout << cities << '\t' << "radius" << '\t' << seconds << '\t' << cities / seconds << std::endl;
+
+		KdTreeMarks marks;
+		seconds = TimeSeconds([&]() {
+			tree.ResetMarks(marks);
+			int current = 0;
+			for (size_t step = 1; step < cities; step++)
+			{
+				tree.Remove(current, marks);
+				current = tree.NearestRemaining(current, marks);
+			}
+		});
+		std::cout << cities << '\t' << "nearest remaining walk" << '\t' << seconds << '\t' << cities / seconds << std::endl;
+
+		DistanceStore distances(locations);
+		seconds = TimeSeconds([&]() { distances.BuildCandidates(10); });
+		std::cout << cities << '\t' << "candidate lists" << '\t' << seconds << '\t' << cities / seconds << std::endl;
+		if (found == 0)
+		{
+			std::cout << "no neighbors found" << std::endl;
+		}
+	}
+}
+
+// Function that returns depots in tight clusters spread over the map, where the nearest neighbors of a city all lie in its
+// own cluster.
+static std::vector<Location> MakeClusteredLocations(size_t count, size_t clusters, unsigned seed)
+{
+	std::mt19937 generator(seed);
+	std::uniform_real_distribution<double> latitude(33.7, 34.3);
+	std::uniform_real_distribution<double> longitude(-118.7, -117.9);
+	std::normal_distribution<double> spread(0.0, 0.003);
+	std::vector<std::pair<double,double>> centers(clusters);
+	for (auto& center : centers)
+	{
+		center = { latitude(generator), longitude(generator) };
+	}
+	std::vector<Location> locations(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		locations[i].mName = "Depot " + std::to_string(i);
+		locations[i].mLatitude = centers[i % clusters].first + spread(generator);
+		locations[i].mLongitude = centers[i % clusters].second + spread(generator);
+	}
+	return locations;
+}
+
+// Compares candidate sets on clustered depots: the k nearest neighbors against the Delaunay neighbors, with or without the
+// nearest city in each quadrant. For each set it reports the time to build the lists, how many candidate edges leave
+// their cluster, and the length and time of Lin-Kernighan from the same Hilbert curve tour.
+void BenchDelaunay()
+{
+	std::cout << "cities	candidate set	k	build seconds	edges leaving cluster	LK seconds	length/nearest 10" << std::endl;
+	const size_t clusterSize = 50;
+	for (size_t cities : { 10000, 100000 })
+	{
+		std::vector<Location> locations = MakeClusteredLocations(cities, cities / clusterSize, 1337);
+		std::vector<ProjectedPoint> points = ProjectLocations(locations);
+		ConstructionScratch constructionScratch;
+		std::vector<int> start;
+		HilbertTour(points, 0.0, 0, constructionScratch, start);
+
+		const std::vector<std::tuple<const char*, CandidateSet, int>> sets = {
+			{ "nearest", CandidateSet::Nearest, 10 },
+			{ "nearest", CandidateSet::Nearest, 6 },
+			{ "delaunay", CandidateSet::Delaunay, 6 },
+			{ "delaunay+quadrant", CandidateSet::DelaunayQuadrant, 6 },
+			{ "delaunay+quadrant", CandidateSet::DelaunayQuadrant, 10 },
+		};
+		double reference = 0.0;
+		for (const auto& [name, set, k] : sets)
+		{
+			DistanceStore distances(locations);
+			double buildSeconds = TimeSeconds([&]() { distances.BuildCandidates(k, set); });
+			size_t leaving = 0;
+			for (size_t city = 0; city < cities; city++)
+			{
+				for (int i = 0; i < k; i++)
+				{
+					leaving += distances.Candidates(static_cast<int>(city))[i] % (cities / clusterSize) != city % (cities / clusterSize);
+				}
+			}
+
+			std::vector<int> tour = start;
+			LocalSearchScratch scratch;
+			double searchSeconds = TimeSeconds([&]() { LinKernighan(tour, distances, 0, scratch); });
+			double length = distances.TourLength(tour);
+			if (reference == 0.0)
+			{
+				reference = length;
+			}
+			std::cout << cities << '\t' << name << '\t' << k << '\t' << buildSeconds << '\t' << leaving << '\t' << searchSeconds << '\t' << length / reference << std::endl;
+		}
+	}
+}
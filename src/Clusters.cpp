@@ -0,0 +1,232 @@
+#include "Clusters.h"
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include "Construction.h"
+#include "Diversity.h"
+#include "LocalSearch.h"
+#include "Rng.h"
+
+// Function that splits order[begin, end) into clusters, cutting it at the median of the wider side of its bounding box
+// so that both halves get a whole number of clusters' worth of points.
+static void SplitCluster(const std::vector<ProjectedPoint>& points, int clusterSize, std::vector<int>& order, size_t begin, size_t end, std::vector<std::vector<int>>& clusters) {
+    size_t count = end - begin;
+    if (count <= static_cast<size_t>(clusterSize)) {
+        clusters.emplace_back(order.begin() + begin, order.begin() + end);
+        return;
+    }
+
+    double minX = points[order[begin]].mX, maxX = minX, minY = points[order[begin]].mY, maxY = minY;
+    for (size_t i = begin; i < end; i++) {
+        minX = std::min(minX, points[order[i]].mX);
+        maxX = std::max(maxX, points[order[i]].mX);
+        minY = std::min(minY, points[order[i]].mY);
+        maxY = std::max(maxY, points[order[i]].mY);
+    }
+    bool alongX = maxX - minX >= maxY - minY;
+
+    size_t parts = (count + clusterSize - 1) / clusterSize;
+    size_t middle = begin + count * (parts / 2) / parts;
+    std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end, [&points, alongX](int a, int b) {
+        double keyA = alongX ? points[a].mX : points[a].mY;
+        double keyB = alongX ? points[b].mX : points[b].mY;
+        return keyA < keyB || (keyA == keyB && a < b);
+    });
+    SplitCluster(points, clusterSize, order, begin, middle, clusters);
+    SplitCluster(points, clusterSize, order, middle, end, clusters);
+}
+
+std::vector<std::vector<int>> ClusterLocations(const std::vector<ProjectedPoint>& points, int clusterSize) {
+    if (clusterSize < 1) {
+        throw std::invalid_argument("The cluster size must be positive");
+    }
+    std::vector<std::vector<int>> clusters;
+    std::vector<int> order(points.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = static_cast<int>(i);
+    }
+    if (!order.empty()) {
+        SplitCluster(points, clusterSize, order, 0, order.size(), clusters);
+    }
+    return clusters;
+}
+
+// Function that runs the genetic algorithm on one cluster, with its own locations and distances in the instance's metric
+// (on the cluster's TSPLIB coordinates, if it has them), and returns the best tour as indices into the cluster.
+template <typename Engine>
+static std::vector<int> SolveCluster(const std::vector<Location>& locations, DistanceMetric metric, std::vector<ProjectedPoint> coordinates, int popSize, int numGenerations, int mutationChance, uint64_t streamSeed, const GAOptions& options, ThreadPool& pool) {
+    DistanceStore distances = metric == DistanceMetric::Haversine ? DistanceStore(locations) : DistanceStore(locations, metric, std::move(coordinates));
+    auto fitnessesOf = [&](const Population& pop) {
+        return metric == DistanceMetric::Haversine ? computeFitnesses(pop, locations) : computeFitnesses(pop, distances);
+    };
+    if (NeedsCandidates(options)) {
+        distances.BuildCandidates(std::min(options.mCandidates, static_cast<int>(locations.size()) - 1), options.mCandidateSet);
+    }
+
+    Engine generator(static_cast<typename Engine::result_type>(streamSeed));
+    int seed = static_cast<int>(streamSeed & 0x7FFFFFFF);
+    Population pop = FillInitialPopulation(popSize, generator, locations, distances, options.mInitialTours);
+    SeedInitialPopulation(pop, generator, distances, options.mSeeding, options.mSeedingFraction);
+    std::vector<std::pair<int,int>> selections;
+    DiversityScratch diversityScratch;
+    for (int genNumber = 1; genNumber <= numGenerations; genNumber++) {
+        std::vector<std::pair<int,double>> fitnesses = fitnessesOf(pop);
+        if (options.mAdaptiveMutation) {
+            mutationChance = AdaptMutationChance(MeasureDiversity(pop, diversityScratch), popSize, mutationChance, options);
+        }
+        pop = NextGeneration(fitnesses, pop, locations, generator, seed, genNumber, popSize, mutationChance, options, distances, pool, selections);
+    }
+
+    std::vector<std::pair<int,double>> fitnesses = fitnessesOf(pop);
+    auto best = std::min_element(fitnesses.begin(), fitnesses.end(), [](const std::pair<int,double>& a, const std::pair<int,double>& b) {
+        return a.second < b.second;
+    });
+    std::vector<int> tour = pop.mMembers[best->first];
+    if (options.mPolish) {
+        LocalSearchScratch scratch;
+        LinKernighan(tour, distances, 0, scratch);
+    }
+    return tour;
+}
+
+// Function that returns the order in which to visit the clusters: a Lin-Kernighan tour through their centers.
+static std::vector<int> OrderClusters(const std::vector<Location>& centers) {
+    std::vector<int> order(centers.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = static_cast<int>(i);
+    }
+    if (centers.size() <= 3) {
+        return order;
+    }
+    DistanceStore distances(centers);
+    distances.BuildCandidates(std::min(10, static_cast<int>(centers.size()) - 1));
+    ConstructionScratch constructionScratch;
+    NearestNeighborTour(distances, 0, constructionScratch, order);
+    LocalSearchScratch scratch;
+    LinKernighan(order, distances, 0, scratch);
+    return order;
+}
+
+template <typename Engine>
+std::vector<int> SolveByClusters(const std::vector<Location>& locations, const DistanceStore& distances, int popSize, int numGenerations, int mutationChance, int seed, const GAOptions& options, ThreadPool& pool) {
+    if (distances.Metric() == DistanceMetric::Explicit) {
+        throw std::invalid_argument("The cluster solver needs coordinates, not an explicit distance matrix");
+    }
+    std::vector<ProjectedPoint> points = ProjectLocations(locations);
+    std::vector<std::vector<int>> clusters = ClusterLocations(points, options.mClusterSize);
+
+    // Solve the clusters in parallel, each on the calling thread of its block.
+    GAOptions clusterOptions = options;
+    clusterOptions.mThreads = 1;
+    clusterOptions.mSolver = SolverMode::Genetic;
+    std::vector<std::vector<int>> tours(clusters.size());
+    pool.ParallelFor(clusters.size(), [&](size_t begin, size_t end, int) {
+        ThreadPool single(1);
+        for (size_t c = begin; c < end; c++) {
+            std::vector<Location> members(clusters[c].size());
+            std::vector<ProjectedPoint> coordinates(distances.Coordinates().empty() ? 0 : members.size());
+            for (size_t i = 0; i < members.size(); i++) {
+                members[i] = locations[clusters[c][i]];
+                if (!coordinates.empty()) {
+                    coordinates[i] = distances.Coordinates()[clusters[c][i]];
+                }
+            }
+            std::vector<int> tour(members.size());
+            for (size_t i = 0; i < tour.size(); i++) {
+                tour[i] = static_cast<int>(i);
+            }
+            // Too few cities for the operators: any order is as good as the others.
+            if (members.size() >= 8) {
+                tour = SolveCluster<Engine>(members, distances.Metric(), std::move(coordinates), popSize, numGenerations, mutationChance, DeriveStreamSeed(seed, c, 0), clusterOptions, single);
+            }
+            for (int& city : tour) {
+                city = clusters[c][city];
+            }
+            tours[c] = std::move(tour);
+        }
+    });
+
+    // The clusters are visited in the order of a tour through their centers.
+    std::vector<Location> centers(clusters.size());
+    for (size_t c = 0; c < clusters.size(); c++) {
+        for (int city : clusters[c]) {
+            centers[c].mLatitude += locations[city].mLatitude / clusters[c].size();
+            centers[c].mLongitude += locations[city].mLongitude / clusters[c].size();
+        }
+    }
+    std::vector<int> order = OrderClusters(centers);
+
+    // Every cluster is stood in for by its member nearest to its center, so the seams are priced in the store's metric.
+    std::vector<int> representatives(clusters.size());
+    for (size_t c = 0; c < clusters.size(); c++) {
+        ProjectedPoint center;
+        for (int city : clusters[c]) {
+            center.mX += points[city].mX / clusters[c].size();
+            center.mY += points[city].mY / clusters[c].size();
+        }
+        representatives[c] = *std::min_element(clusters[c].begin(), clusters[c].end(), [&points, &center](int a, int b) {
+            double dA = (points[a].mX - center.mX) * (points[a].mX - center.mX) + (points[a].mY - center.mY) * (points[a].mY - center.mY);
+            double dB = (points[b].mX - center.mX) * (points[b].mX - center.mX) + (points[b].mY - center.mY) * (points[b].mY - center.mY);
+            return dA < dB;
+        });
+    }
+
+    // Cut every cluster tour open at the edge that best joins the previous cluster's last city to this cluster, and this
+    // cluster's last city to the next cluster's representative, and walk it in the better direction.
+    std::vector<int> tour;
+    tour.reserve(locations.size());
+    std::vector<size_t> seams(order.size());
+    for (size_t step = 0; step < order.size(); step++) {
+        const std::vector<int>& cycle = tours[order[step]];
+        seams[step] = tour.size();
+        int next = representatives[order[(step + 1) % order.size()]];
+        size_t size = cycle.size();
+        double bestCost = 0.0;
+        size_t bestCut = 0;
+        bool bestForward = true;
+        for (size_t i = 0; i < size; i++) {
+            int a = cycle[i];
+            int b = cycle[(i + 1) % size];
+            // Walking forward enters at b and leaves at a; walking backward enters at a and leaves at b.
+            for (bool forward : { true, false }) {
+                int entry = forward ? b : a;
+                int exit = forward ? a : b;
+                double cost = distances.Get(exit, next) - (size > 1 ? distances.Get(a, b) : 0.0);
+                if (!tour.empty()) {
+                    cost += distances.Get(tour.back(), entry);
+                }
+                if ((i == 0 && forward) || cost < bestCost) {
+                    bestCost = cost;
+                    bestCut = i;
+                    bestForward = forward;
+                }
+            }
+        }
+        for (size_t i = 0; i < size; i++) {
+            tour.push_back(bestForward ? cycle[(bestCut + 1 + i) % size] : cycle[(bestCut + size - i) % size]);
+        }
+    }
+
+    // Repair the seams between the clusters. The cluster tours are already optimized, so only the cities within a few
+    // positions of a seam, and their candidate neighbors, start off their don't-look bits.
+    std::vector<int> active;
+    if (order.size() > 1) {
+        for (size_t seam : seams) {
+            for (size_t offset = 0; offset < 6; offset++) {
+                int city = tour[(seam + tour.size() - 3 + offset) % tour.size()];
+                active.push_back(city);
+                active.insert(active.end(), distances.Candidates(city), distances.Candidates(city) + distances.CandidateCount());
+            }
+        }
+    }
+    std::rotate(tour.begin(), std::find(tour.begin(), tour.end(), 0), tour.end());
+    if (tour.size() >= 8 && !active.empty()) {
+        LocalSearchScratch scratch;
+        LinKernighan(tour, distances, active, 0, scratch);
+    }
+    return tour;
+}
+
+template std::vector<int> SolveByClusters<std::mt19937>(const std::vector<Location>&, const DistanceStore&, int, int, int, int, const GAOptions&, ThreadPool&);
+template std::vector<int> SolveByClusters<Xoshiro256StarStar>(const std::vector<Location>&, const DistanceStore&, int, int, int, int, const GAOptions&, ThreadPool&);
+template std::vector<int> SolveByClusters<Pcg64>(const std::vector<Location>&, const DistanceStore&, int, int, int, int, const GAOptions&, ThreadPool&);
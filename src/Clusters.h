@@ -0,0 +1,24 @@
+#pragma once
+#include <vector>
+#include "Distance.h"
+#include "Parallel.h"
+#include "TSP.h"
+
+// Divide and conquer for instances too large for the genetic algorithm, where every member is a full permutation. The
+// locations are split into compact clusters of at most clusterSize cities, the genetic algorithm solves every cluster on
+// its own (the clusters in parallel on the thread pool), a Lin-Kernighan search orders the clusters by their centers, and
+// the cluster tours are cut open and joined in that order. A Lin-Kernighan search that starts only at the cities near
+// the seams, and only spreads as far as its moves change the tour, then repairs them. The work grows about linearly
+// with the number of clusters.
+
+// Function that splits the locations into clusters of clusterSize / 2 to clusterSize cities (fewer only when there are
+// fewer locations) by cutting the points in two at the median of their wider side, over and over. Neighboring clusters
+// come next to each other in the result.
+std::vector<std::vector<int>> ClusterLocations(const std::vector<ProjectedPoint>& points, int clusterSize);
+
+// Function that solves the instance by clusters: each cluster runs popSize members for numGenerations generations with the
+// given options on a generator of type Engine seeded from seed and the cluster's index, so the tour does not depend on
+// the thread count. The distance store must have candidate lists and coordinates (not an explicit matrix). Returns a
+// tour that starts at location 0.
+template <typename Engine>
+std::vector<int> SolveByClusters(const std::vector<Location>& locations, const DistanceStore& distances, int popSize, int numGenerations, int mutationChance, int seed, const GAOptions& options, ThreadPool& pool);
@@ -0,0 +1,691 @@
+#include "Construction.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include "Rng.h"
+
+// Function that removes a city from the unvisited list in O(1) by moving the last entry into its place.
+static void RemoveUnvisited(ConstructionScratch& scratch, int city) {
+    int index = scratch.mPositions[city];
+    int last = scratch.mUnvisited.back();
+    scratch.mUnvisited[index] = last;
+    scratch.mPositions[last] = index;
+    scratch.mUnvisited.pop_back();
+}
+
+// Function that returns the unvisited city nearest to from: the first unvisited candidate, or else the nearest city left
+// according to the KD-tree, whose marks must match the unvisited list. An explicit matrix may come without a placement
+// of its locations, so there the unvisited list is scanned for the nearest city by the matrix instead.
+static int NearestUnvisited(const DistanceStore& distances, const ConstructionScratch& scratch, int from) {
+    const int* candidates = distances.Candidates(from);
+    for (int i = 0; i < distances.CandidateCount(); i++) {
+        if (!scratch.mVisited[candidates[i]]) {
+            return candidates[i];
+        }
+    }
+    if (distances.Metric() == DistanceMetric::Explicit) {
+        return *std::min_element(scratch.mUnvisited.begin(), scratch.mUnvisited.end(), [&distances, from](int a, int b) {
+            return distances.Get(from, a) < distances.Get(from, b);
+        });
+    }
+    return distances.Tree().NearestRemaining(from, scratch.mMarks);
+}
+
+// Function that rotates a finished tour so that location 0 comes first.
+static void StartAtZero(std::vector<int>& tour) {
+    std::rotate(tour.begin(), std::find(tour.begin(), tour.end(), 0), tour.end());
+}
+
+void NearestNeighborTour(const DistanceStore& distances, int start, ConstructionScratch& scratch, std::vector<int>& tour) {
+    int size = static_cast<int>(distances.Size());
+    scratch.mVisited.assign(size, 0);
+    scratch.mUnvisited.resize(size);
+    scratch.mPositions.resize(size);
+    for (int city = 0; city < size; city++) {
+        scratch.mUnvisited[city] = city;
+        scratch.mPositions[city] = city;
+    }
+    distances.Tree().ResetMarks(scratch.mMarks);
+
+    tour.clear();
+    int current = start;
+    while (true) {
+        tour.push_back(current);
+        scratch.mVisited[current] = 1;
+        RemoveUnvisited(scratch, current);
+        distances.Tree().Remove(current, scratch.mMarks);
+        if (scratch.mUnvisited.empty()) {
+            break;
+        }
+        current = NearestUnvisited(distances, scratch, current);
+    }
+    StartAtZero(tour);
+}
+
+// Function that finds the root of a city's fragment, halving the path on the way.
+static int FindFragment(std::vector<int>& parents, int city) {
+    while (parents[city] != city) {
+        parents[city] = parents[parents[city]];
+        city = parents[city];
+    }
+    return city;
+}
+
+// Function that returns a uniform random number in [0, 1).
+static double UnitRandom(SplitMix64& random) {
+    return static_cast<double>(random() >> 11) * 0x1.0p-53;
+}
+
+// Function that lists every candidate edge once, as (smaller city, larger city) packed into a key, with its length
+// (times a random factor in [1, 1 + noise)), shortest first.
+static void SortedCandidateEdges(const DistanceStore& distances, double noise, uint64_t seed, std::vector<std::pair<double,uint64_t>>& edges) {
+    int size = static_cast<int>(distances.Size());
+    edges.clear();
+    for (int a = 0; a < size; a++) {
+        const int* candidates = distances.Candidates(a);
+        for (int i = 0; i < distances.CandidateCount(); i++) {
+            uint64_t low = static_cast<uint64_t>(std::min(a, candidates[i]));
+            uint64_t high = static_cast<uint64_t>(std::max(a, candidates[i]));
+            edges.emplace_back(distances.Get(a, candidates[i]), (low << 32) | high);
+        }
+    }
+    std::sort(edges.begin(), edges.end(), [](const std::pair<double,uint64_t>& x, const std::pair<double,uint64_t>& y) {
+        return x.second < y.second;
+    });
+    edges.erase(std::unique(edges.begin(), edges.end(), [](const std::pair<double,uint64_t>& x, const std::pair<double,uint64_t>& y) {
+        return x.second == y.second;
+    }), edges.end());
+    if (noise > 0.0) {
+        SplitMix64 random(seed);
+        for (auto& edge : edges) {
+            edge.first *= 1.0 + noise * UnitRandom(random);
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+}
+
+void GreedyEdgeTour(const DistanceStore& distances, double noise, uint64_t seed, ConstructionScratch& scratch, std::vector<int>& tour) {
+    int size = static_cast<int>(distances.Size());
+    tour.clear();
+    if (size < 3) {
+        for (int city = 0; city < size; city++) {
+            tour.push_back(city);
+        }
+        return;
+    }
+
+    std::vector<std::pair<double,uint64_t>>& edges = scratch.mEdges;
+    SortedCandidateEdges(distances, noise, seed, edges);
+
+    // Take the edges shortest first while they keep every city at degree 2 or less and close no cycle.
+    std::vector<int>& parents = scratch.mParents;
+    std::vector<int>& adjacent = scratch.mAdjacent;
+    parents.resize(size);
+    for (int city = 0; city < size; city++) {
+        parents[city] = city;
+    }
+    adjacent.assign(2 * static_cast<size_t>(size), -1);
+    for (const auto& edge : edges) {
+        int a = static_cast<int>(edge.second >> 32);
+        int b = static_cast<int>(edge.second & 0xFFFFFFFFu);
+        if (adjacent[2 * a + 1] >= 0 || adjacent[2 * b + 1] >= 0) {
+            continue;
+        }
+        int rootA = FindFragment(parents, a);
+        int rootB = FindFragment(parents, b);
+        if (rootA == rootB) {
+            continue;
+        }
+        parents[rootA] = rootB;
+        adjacent[2 * a + (adjacent[2 * a] >= 0 ? 1 : 0)] = b;
+        adjacent[2 * b + (adjacent[2 * b] >= 0 ? 1 : 0)] = a;
+    }
+
+    // The fragment ends (cities with fewer than two edges) are what the nearest neighbor walk links up. Lone cities are
+    // both ends of their fragment and are listed once.
+    std::vector<int>& ends = scratch.mUnvisited;
+    std::vector<int>& positions = scratch.mPositions;
+    scratch.mVisited.assign(size, 1);
+    ends.clear();
+    positions.resize(size);
+    distances.Tree().ResetMarks(scratch.mMarks);
+    for (int city = 0; city < size; city++) {
+        if (adjacent[2 * city + 1] < 0) {
+            positions[city] = static_cast<int>(ends.size());
+            ends.push_back(city);
+            scratch.mVisited[city] = 0;
+        }
+        else {
+            distances.Tree().Remove(city, scratch.mMarks);
+        }
+    }
+
+    int current = ends[0];
+    while (true) {
+        // Walk the fragment from this end to its other end.
+        RemoveUnvisited(scratch, current);
+        distances.Tree().Remove(current, scratch.mMarks);
+        scratch.mVisited[current] = 1;
+        int previous = -1;
+        while (true) {
+            tour.push_back(current);
+            int next = -1;
+            for (int k = 0; k < 2; k++) {
+                int neighbor = adjacent[2 * current + k];
+                if (neighbor >= 0 && neighbor != previous) {
+                    next = neighbor;
+                }
+            }
+            if (next < 0) {
+                break;
+            }
+            previous = current;
+            current = next;
+        }
+        if (!scratch.mVisited[current]) {
+            RemoveUnvisited(scratch, current);
+            distances.Tree().Remove(current, scratch.mMarks);
+            scratch.mVisited[current] = 1;
+        }
+        if (ends.empty()) {
+            break;
+        }
+        // Jump to the nearest end of a fragment that is not in the tour yet.
+        current = NearestUnvisited(distances, scratch, current);
+    }
+    StartAtZero(tour);
+}
+
+// Function that returns the index of cell (x, y) along the Hilbert curve that covers a 2^order by 2^order grid.
+static uint64_t HilbertIndex(uint32_t x, uint32_t y, int order) {
+    uint64_t index = 0;
+    for (uint32_t half = 1u << (order - 1); half > 0; half >>= 1) {
+        uint32_t rx = (x & half) ? 1 : 0;
+        uint32_t ry = (y & half) ? 1 : 0;
+        index += static_cast<uint64_t>(half) * half * ((3 * rx) ^ ry);
+        // Rotate the quadrant so the curve inside it runs the same way as the whole curve.
+        if (ry == 0) {
+            if (rx == 1) {
+                x = half - 1 - (x & (half - 1));
+                y = half - 1 - (y & (half - 1));
+            }
+            std::swap(x, y);
+        }
+        x &= half - 1;
+        y &= half - 1;
+    }
+    return index;
+}
+
+void HilbertTour(const std::vector<ProjectedPoint>& points, double shift, uint64_t seed, ConstructionScratch& scratch, std::vector<int>& tour) {
+    int size = static_cast<int>(points.size());
+    tour.clear();
+    if (size == 0) {
+        return;
+    }
+
+    double minX = points[0].mX;
+    double maxX = points[0].mX;
+    double minY = points[0].mY;
+    double maxY = points[0].mY;
+    for (const ProjectedPoint& point : points) {
+        minX = std::min(minX, point.mX);
+        maxX = std::max(maxX, point.mX);
+        minY = std::min(minY, point.mY);
+        maxY = std::max(maxY, point.mY);
+    }
+
+    // A 2^20 by 2^20 grid over the bounding square, grown by the shift so shifted points stay on it.
+    const int order = 20;
+    const double cells = static_cast<double>(1u << order);
+    double side = std::max(std::max(maxX - minX, maxY - minY), 1e-12);
+    double offsetX = 0.0;
+    double offsetY = 0.0;
+    int mirror = 0;
+    if (shift > 0.0) {
+        SplitMix64 random(seed);
+        offsetX = shift * side * UnitRandom(random);
+        offsetY = shift * side * UnitRandom(random);
+        mirror = static_cast<int>(random() & 7);
+    }
+    double scale = (cells - 1.0) / (side * (1.0 + shift));
+
+    std::vector<std::pair<uint64_t,int>>& keys = scratch.mCurveKeys;
+    keys.resize(size);
+    for (int city = 0; city < size; city++) {
+        uint32_t x = static_cast<uint32_t>((points[city].mX - minX + offsetX) * scale);
+        uint32_t y = static_cast<uint32_t>((points[city].mY - minY + offsetY) * scale);
+        if (mirror & 1) {
+            x = (1u << order) - 1 - x;
+        }
+        if (mirror & 2) {
+            y = (1u << order) - 1 - y;
+        }
+        if (mirror & 4) {
+            std::swap(x, y);
+        }
+        keys[city] = { HilbertIndex(x, y, order), city };
+    }
+    std::sort(keys.begin(), keys.end());
+
+    tour.resize(size);
+    for (int i = 0; i < size; i++) {
+        tour[i] = keys[i].second;
+    }
+    StartAtZero(tour);
+}
+
+// Function that prepares the insertion heuristics: every city unvisited and outside the tour, the noise factors, and the
+// reverse candidate lists that tell which cities may insert next to a city that just joined the tour.
+static void StartInsertion(const DistanceStore& distances, double noise, uint64_t seed, ConstructionScratch& scratch) {
+    int size = static_cast<int>(distances.Size());
+    scratch.mVisited.assign(size, 0);
+    scratch.mUnvisited.resize(size);
+    scratch.mPositions.resize(size);
+    scratch.mNext.assign(size, -1);
+    scratch.mPrev.assign(size, -1);
+    for (int city = 0; city < size; city++) {
+        scratch.mUnvisited[city] = city;
+        scratch.mPositions[city] = city;
+    }
+
+    scratch.mFactors.assign(size, 1.0);
+    if (noise > 0.0) {
+        SplitMix64 random(seed);
+        for (double& factor : scratch.mFactors) {
+            factor += noise * UnitRandom(random);
+        }
+    }
+
+    std::vector<int>& offsets = scratch.mReverseOffsets;
+    offsets.assign(size + 1, 0);
+    for (int a = 0; a < size; a++) {
+        const int* candidates = distances.Candidates(a);
+        for (int i = 0; i < distances.CandidateCount(); i++) {
+            offsets[candidates[i] + 1]++;
+        }
+    }
+    for (int city = 0; city < size; city++) {
+        offsets[city + 1] += offsets[city];
+    }
+    scratch.mReverseCandidates.resize(offsets[size]);
+    std::vector<int>& cursors = scratch.mPlaces;
+    cursors.assign(offsets.begin(), offsets.end() - 1);
+    for (int a = 0; a < size; a++) {
+        const int* candidates = distances.Candidates(a);
+        for (int i = 0; i < distances.CandidateCount(); i++) {
+            scratch.mReverseCandidates[cursors[candidates[i]]++] = a;
+        }
+    }
+}
+
+// Function that puts a city into the partial tour after the tour city place (a tour of one city links to itself).
+static void InsertAfter(ConstructionScratch& scratch, int place, int city) {
+    if (place < 0) {
+        scratch.mNext[city] = city;
+        scratch.mPrev[city] = city;
+    }
+    else {
+        int after = scratch.mNext[place];
+        scratch.mNext[place] = city;
+        scratch.mPrev[city] = place;
+        scratch.mNext[city] = after;
+        scratch.mPrev[after] = city;
+    }
+    scratch.mVisited[city] = 1;
+    RemoveUnvisited(scratch, city);
+}
+
+// Function that returns the length city adds to the tour when it goes between place and the city after it.
+static double InsertionCost(const DistanceStore& distances, const ConstructionScratch& scratch, int place, int city) {
+    int after = scratch.mNext[place];
+    return distances.Get(place, city) + distances.Get(city, after) - distances.Get(place, after);
+}
+
+// Function that returns the tour city after which city is cheapest to insert, among the tour edges at its candidate
+// neighbors, and -1 when none of them is in the tour.
+static int CheapestCandidatePlace(const DistanceStore& distances, const ConstructionScratch& scratch, int city, double& cost) {
+    int best = -1;
+    const int* candidates = distances.Candidates(city);
+    for (int i = 0; i < distances.CandidateCount(); i++) {
+        int neighbor = candidates[i];
+        if (!scratch.mVisited[neighbor]) {
+            continue;
+        }
+        for (int place : { neighbor, scratch.mPrev[neighbor] }) {
+            double added = InsertionCost(distances, scratch, place, city);
+            if (best < 0 || added < cost) {
+                best = place;
+                cost = added;
+            }
+        }
+    }
+    return best;
+}
+
+// Function that returns the tour city after which city is cheapest to insert, trying every tour edge from start on.
+static int CheapestPlace(const DistanceStore& distances, const ConstructionScratch& scratch, int start, int city) {
+    int best = start;
+    double cost = InsertionCost(distances, scratch, start, city);
+    for (int place = scratch.mNext[start]; place != start; place = scratch.mNext[place]) {
+        double added = InsertionCost(distances, scratch, place, city);
+        if (added < cost) {
+            best = place;
+            cost = added;
+        }
+    }
+    return best;
+}
+
+// Function that writes the partial tour, once it holds every city, into tour starting at location 0.
+static void CollectTour(const ConstructionScratch& scratch, std::vector<int>& tour) {
+    tour.clear();
+    int city = 0;
+    do {
+        tour.push_back(city);
+        city = scratch.mNext[city];
+    } while (city != 0);
+}
+
+// Function that inserts the remaining cities into the partial tour, the one with the smallest key first. A city's key is
+// its cheapest insertion cost, or with ratio that cost's two new edges over the edge they replace, times its noise
+// factor. Keys live in a lazy heap: an entry is stale once the city's version moved on, which happens whenever one of
+// its candidate neighbors joins the tour or has a tour edge split.
+static void InsertByKey(const DistanceStore& distances, bool ratio, ConstructionScratch& scratch) {
+    int size = static_cast<int>(distances.Size());
+    std::vector<std::pair<double,uint64_t>>& heap = scratch.mHeap;
+    std::vector<uint32_t>& versions = scratch.mVersions;
+    std::vector<int>& places = scratch.mPlaces;
+    heap.clear();
+    versions.assign(size, 0);
+    places.assign(size, -1);
+    auto greater = std::greater<std::pair<double,uint64_t>>();
+
+    auto evaluate = [&](int city) {
+        ++versions[city];
+        double cost = 0.0;
+        int place = CheapestCandidatePlace(distances, scratch, city, cost);
+        places[city] = place;
+        if (place < 0) {
+            return;
+        }
+        double key = cost;
+        if (ratio) {
+            double replaced = distances.Get(place, scratch.mNext[place]);
+            key = (cost + replaced) / std::max(replaced, 1e-12);
+        }
+        heap.emplace_back(key * scratch.mFactors[city], (static_cast<uint64_t>(city) << 32) | versions[city]);
+        std::push_heap(heap.begin(), heap.end(), greater);
+    };
+    auto touch = [&](int city) {
+        for (int i = scratch.mReverseOffsets[city]; i < scratch.mReverseOffsets[city + 1]; i++) {
+            int other = scratch.mReverseCandidates[i];
+            if (!scratch.mVisited[other]) {
+                evaluate(other);
+            }
+        }
+    };
+
+    // Any city of the partial tour, where a scan of the whole tour starts (location 0 may not be in it yet).
+    int anchor = -1;
+    for (int city = 0; city < size; city++) {
+        if (scratch.mVisited[city]) {
+            touch(city);
+            anchor = city;
+        }
+    }
+    while (!scratch.mUnvisited.empty()) {
+        int city = -1;
+        int place = -1;
+        while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), greater);
+            uint64_t entry = heap.back().second;
+            heap.pop_back();
+            int candidate = static_cast<int>(entry >> 32);
+            if (!scratch.mVisited[candidate] && versions[candidate] == static_cast<uint32_t>(entry & 0xFFFFFFFFu)) {
+                city = candidate;
+                place = places[candidate];
+                break;
+            }
+        }
+        if (city < 0) {
+            // No city has a candidate neighbor in the tour (the candidate graph is not connected): scan the whole tour.
+            city = scratch.mUnvisited[0];
+            place = CheapestPlace(distances, scratch, anchor, city);
+        }
+        int after = scratch.mNext[place];
+        InsertAfter(scratch, place, city);
+        touch(place);
+        touch(after);
+        touch(city);
+    }
+}
+
+void CheapestInsertionTour(const DistanceStore& distances, double noise, uint64_t seed, ConstructionScratch& scratch, std::vector<int>& tour) {
+    tour.clear();
+    if (distances.Size() == 0) {
+        return;
+    }
+    StartInsertion(distances, noise, seed, scratch);
+    InsertAfter(scratch, -1, 0);
+    InsertByKey(distances, false, scratch);
+    CollectTour(scratch, tour);
+}
+
+void FarthestInsertionTour(const DistanceStore& distances, const std::vector<ProjectedPoint>& points, double noise, uint64_t seed, ConstructionScratch& scratch, std::vector<int>& tour) {
+    tour.clear();
+    if (distances.Size() == 0) {
+        return;
+    }
+    StartInsertion(distances, noise, seed, scratch);
+    InsertAfter(scratch, -1, 0);
+
+    // Squared distance on the plane from every city to the nearest tour city, times its squared noise factor.
+    std::vector<double>& scores = scratch.mScores;
+    scores.assign(points.size(), 0.0);
+    int latest = 0;
+    for (int city : scratch.mUnvisited) {
+        scores[city] = std::numeric_limits<double>::infinity();
+    }
+    while (!scratch.mUnvisited.empty()) {
+        // Bring the distances up to date with the latest tour city and find the farthest city on the same pass.
+        int farthest = -1;
+        for (int city : scratch.mUnvisited) {
+            double dx = points[city].mX - points[latest].mX;
+            double dy = points[city].mY - points[latest].mY;
+            double factor = scratch.mFactors[city];
+            scores[city] = std::min(scores[city], (dx * dx + dy * dy) * factor * factor);
+            if (farthest < 0 || scores[city] > scores[farthest]) {
+                farthest = city;
+            }
+        }
+        double cost = 0.0;
+        int place = CheapestCandidatePlace(distances, scratch, farthest, cost);
+        if (place < 0) {
+            place = CheapestPlace(distances, scratch, latest, farthest);
+        }
+        InsertAfter(scratch, place, farthest);
+        latest = farthest;
+    }
+    CollectTour(scratch, tour);
+}
+
+// Function that returns the cities on the convex hull of the points in counterclockwise order (Andrew's monotone chain).
+static void ConvexHull(const std::vector<ProjectedPoint>& points, std::vector<int>& order, std::vector<int>& hull) {
+    order.resize(points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+        order[i] = static_cast<int>(i);
+    }
+    std::sort(order.begin(), order.end(), [&points](int a, int b) {
+        return points[a].mX < points[b].mX || (points[a].mX == points[b].mX && points[a].mY < points[b].mY);
+    });
+    auto turn = [&points](int o, int a, int b) {
+        return (points[a].mX - points[o].mX) * (points[b].mY - points[o].mY) - (points[a].mY - points[o].mY) * (points[b].mX - points[o].mX);
+    };
+
+    hull.clear();
+    // The lower chain left to right, then the upper chain right to left, keeping only left turns.
+    for (int pass = 0; pass < 2; pass++) {
+        size_t floor = hull.size();
+        for (size_t i = 0; i < order.size(); i++) {
+            int city = order[pass == 0 ? i : order.size() - 1 - i];
+            while (hull.size() >= floor + 2 && turn(hull[hull.size() - 2], hull.back(), city) <= 0) {
+                hull.pop_back();
+            }
+            hull.push_back(city);
+        }
+        hull.pop_back();
+    }
+    if (hull.empty()) {
+        hull.push_back(order[0]);
+    }
+}
+
+void ConvexHullInsertionTour(const DistanceStore& distances, const std::vector<ProjectedPoint>& points, double noise, uint64_t seed, ConstructionScratch& scratch, std::vector<int>& tour) {
+    tour.clear();
+    if (distances.Size() == 0) {
+        return;
+    }
+    StartInsertion(distances, noise, seed, scratch);
+    std::vector<int>& hull = scratch.mStack;
+    ConvexHull(points, scratch.mLinks, hull);
+    int previous = -1;
+    for (int city : hull) {
+        InsertAfter(scratch, previous, city);
+        previous = city;
+    }
+    InsertByKey(distances, true, scratch);
+    CollectTour(scratch, tour);
+}
+
+void ChristofidesTour(const DistanceStore& distances, double noise, uint64_t seed, ConstructionScratch& scratch, std::vector<int>& tour) {
+    int size = static_cast<int>(distances.Size());
+    tour.clear();
+    if (size == 0) {
+        return;
+    }
+    std::vector<std::pair<double,uint64_t>>& edges = scratch.mEdges;
+    SortedCandidateEdges(distances, noise, seed, edges);
+
+    // Kruskal's minimum spanning tree (a forest if the candidate graph is not connected), as a list of end pairs.
+    std::vector<int>& parents = scratch.mParents;
+    std::vector<int>& ends = scratch.mAdjacent;
+    std::vector<int>& degrees = scratch.mPositions;
+    parents.resize(size);
+    for (int city = 0; city < size; city++) {
+        parents[city] = city;
+    }
+    ends.clear();
+    degrees.assign(size, 0);
+    for (const auto& edge : edges) {
+        int a = static_cast<int>(edge.second >> 32);
+        int b = static_cast<int>(edge.second & 0xFFFFFFFFu);
+        int rootA = FindFragment(parents, a);
+        int rootB = FindFragment(parents, b);
+        if (rootA != rootB) {
+            parents[rootA] = rootB;
+            ends.push_back(a);
+            ends.push_back(b);
+            degrees[a]++;
+            degrees[b]++;
+        }
+    }
+
+    // Match the odd-degree cities greedily: the shortest candidate edges first, then the nearest city for those left.
+    std::vector<char>& matched = scratch.mVisited;
+    matched.assign(size, 1);
+    for (int city = 0; city < size; city++) {
+        if (degrees[city] % 2 == 1) {
+            matched[city] = 0;
+        }
+    }
+    for (const auto& edge : edges) {
+        int a = static_cast<int>(edge.second >> 32);
+        int b = static_cast<int>(edge.second & 0xFFFFFFFFu);
+        if (!matched[a] && !matched[b]) {
+            matched[a] = 1;
+            matched[b] = 1;
+            ends.push_back(a);
+            ends.push_back(b);
+        }
+    }
+    std::vector<int>& left = scratch.mUnvisited;
+    left.clear();
+    for (int city = 0; city < size; city++) {
+        if (!matched[city]) {
+            left.push_back(city);
+        }
+    }
+    for (size_t i = 0; i < left.size(); i++) {
+        if (matched[left[i]]) {
+            continue;
+        }
+        int nearest = -1;
+        for (size_t j = i + 1; j < left.size(); j++) {
+            if (!matched[left[j]] && (nearest < 0 || distances.Get(left[i], left[j]) < distances.Get(left[i], nearest))) {
+                nearest = left[j];
+            }
+        }
+        matched[left[i]] = 1;
+        matched[nearest] = 1;
+        ends.push_back(left[i]);
+        ends.push_back(nearest);
+    }
+
+    // The multigraph of tree and matching edges in compressed rows: every city has an even degree now.
+    int edgeCount = static_cast<int>(ends.size() / 2);
+    std::vector<int>& offsets = scratch.mOffsets;
+    std::vector<int>& links = scratch.mLinks;
+    std::vector<int>& linkEdges = scratch.mLinkEdges;
+    offsets.assign(size + 1, 0);
+    for (int city : ends) {
+        offsets[city + 1]++;
+    }
+    for (int city = 0; city < size; city++) {
+        offsets[city + 1] += offsets[city];
+    }
+    links.resize(ends.size());
+    linkEdges.resize(ends.size());
+    std::vector<int>& cursors = scratch.mPositions;
+    cursors.assign(offsets.begin(), offsets.end() - 1);
+    for (int e = 0; e < edgeCount; e++) {
+        int a = ends[2 * e];
+        int b = ends[2 * e + 1];
+        links[cursors[a]] = b;
+        linkEdges[cursors[a]++] = e;
+        links[cursors[b]] = a;
+        linkEdges[cursors[b]++] = e;
+    }
+
+    // Hierholzer's Euler circuit of every component, skipping the cities already in the tour.
+    std::vector<char>& used = scratch.mUsed;
+    std::vector<char>& seen = scratch.mVisited;
+    std::vector<int>& stack = scratch.mStack;
+    used.assign(edgeCount, 0);
+    seen.assign(size, 0);
+    cursors.assign(offsets.begin(), offsets.end() - 1);
+    for (int start = 0; start < size; start++) {
+        if (seen[start]) {
+            continue;
+        }
+        stack.assign(1, start);
+        while (!stack.empty()) {
+            int city = stack.back();
+            while (cursors[city] < offsets[city + 1] && used[linkEdges[cursors[city]]]) {
+                cursors[city]++;
+            }
+            if (cursors[city] < offsets[city + 1]) {
+                used[linkEdges[cursors[city]]] = 1;
+                stack.push_back(links[cursors[city]]);
+            }
+            else {
+                stack.pop_back();
+                if (!seen[city]) {
+                    seen[city] = 1;
+                    tour.push_back(city);
+                }
+            }
+        }
+    }
+    StartAtZero(tour);
+}
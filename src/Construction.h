@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "Distance.h"
+
+// Tour construction heuristics that seed the initial population with tours far shorter than random ones. They look up
+// the distance store's candidate lists first and only fall back to the KD-tree (or to scanning the tour) when no
+// candidate is left, so they are close to linear once candidates are built. Every tour they build starts at location 0.
+
+// Scratch buffers reused across tours
+struct ConstructionScratch
+{
+	std::vector<char> mVisited;
+	std::vector<int> mUnvisited; // cities not in the tour yet, in no particular order
+	std::vector<int> mPositions; // index of every city in mUnvisited (or in the endpoint list)
+	std::vector<std::pair<double,uint64_t>> mEdges;
+	std::vector<int> mParents; // union-find forest of the greedy fragments
+	std::vector<int> mAdjacent; // two tour neighbors per city, -1 when missing
+	std::vector<std::pair<uint64_t,int>> mCurveKeys; // (Hilbert index, city)
+	std::vector<int> mNext; // the partial tour of the insertion heuristics, as a doubly linked cycle
+	std::vector<int> mPrev;
+	std::vector<double> mFactors; // noise factor of every city
+	std::vector<double> mScores;
+	std::vector<int> mPlaces; // tour city after which a city is best inserted
+	std::vector<uint32_t> mVersions;
+	std::vector<std::pair<double,uint64_t>> mHeap; // (key, city << 32 | version)
+	std::vector<int> mReverseOffsets; // cities that have a given city as a candidate, in compressed rows
+	std::vector<int> mReverseCandidates;
+	std::vector<int> mOffsets; // edges of the Christofides multigraph at every city, in compressed rows
+	std::vector<int> mLinks;
+	std::vector<int> mLinkEdges;
+	std::vector<char> mUsed;
+	std::vector<int> mStack;
+	KdTreeMarks mMarks; // the cities the nearest neighbor walks can still go to
+};
+
+// Nearest neighbor: from start, repeatedly moves to the nearest city that is not in the tour yet.
+void NearestNeighborTour(const DistanceStore& distances, int start, ConstructionScratch& scratch, std::vector<int>& tour);
+
+// Greedy edge matching: takes the candidate edges shortest first whenever both ends still have fewer than two tour edges
+// and the edge closes no cycle, then links the resulting fragments end to end by nearest neighbor. With noise above 0
+// every edge length is multiplied by a factor drawn uniformly from [1, 1 + noise) (from seed), which gives different
+// greedy tours for different seeds.
+void GreedyEdgeTour(const DistanceStore& distances, double noise, uint64_t seed, ConstructionScratch& scratch, std::vector<int>& tour);
+
+// Insertion heuristics: they grow a partial tour one city at a time, putting each city between the two tour neighbors
+// where it adds the least length. Only the tour edges at a city's candidate neighbors are tried, and all of them only
+// when no candidate is in the tour yet, so an insertion costs O(k) instead of O(N). With noise above 0 the key that
+// picks the next city is multiplied by a factor drawn uniformly from [1, 1 + noise) per city (from seed).
+
+// Cheapest insertion: starts from location 0 and always inserts the city that adds the least length. O(N k^2 log N).
+void CheapestInsertionTour(const DistanceStore& distances, double noise, uint64_t seed, ConstructionScratch& scratch, std::vector<int>& tour);
+
+// Farthest insertion: starts from location 0 and always inserts the city farthest from the tour, measured on the
+// projected points, so the tour takes the rough shape of the instance early on. Finding that city costs O(N) per step,
+// which makes the whole construction O(N^2).
+void FarthestInsertionTour(const DistanceStore& distances, const std::vector<ProjectedPoint>& points, double noise, uint64_t seed, ConstructionScratch& scratch, std::vector<int>& tour);
+
+// Convex hull insertion: starts from the convex hull of the projected points and inserts the city whose cheapest
+// insertion has the smallest ratio of the two new edges to the edge they replace. O(N k^2 log N).
+void ConvexHullInsertionTour(const DistanceStore& distances, const std::vector<ProjectedPoint>& points, double noise, uint64_t seed, ConstructionScratch& scratch, std::vector<int>& tour);
+
+// Christofides style: a minimum spanning tree of the candidate edges, plus a greedy matching of its odd-degree cities
+// (instead of a minimum-weight perfect matching), walked as an Euler circuit that skips cities seen before. Noise
+// perturbs the edge lengths as in GreedyEdgeTour.
+void ChristofidesTour(const DistanceStore& distances, double noise, uint64_t seed, ConstructionScratch& scratch, std::vector<int>& tour);
+
+// Space-filling curve: visits the points in the order of a Hilbert curve over their bounding square, in O(N log N) and
+// without looking at a single distance. Tours are about 25% longer than optimal on uniform points. With shift above 0
+// the curve's grid moves by up to shift times the square's side along each axis and takes one of its 8 mirror images
+// (from seed), which gives different tours for different seeds.
+void HilbertTour(const std::vector<ProjectedPoint>& points, double shift, uint64_t seed, ConstructionScratch& scratch, std::vector<int>& tour);
@@ -0,0 +1,324 @@
+#include "Delaunay.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // The triangulation as half-edges: half-edge 3t + i starts at vertex mStarts[3t + i] and runs to the start of the
+    // next half-edge of triangle t, counterclockwise. mTwins holds the half-edge running the other way, or -1 on the
+    // convex hull. mHullEdges keeps, for every vertex on the hull, its hull half-edge.
+    struct Triangulation
+    {
+        const std::vector<ProjectedPoint>* mPoints = nullptr;
+        std::vector<int> mStarts;
+        std::vector<int> mTwins;
+        std::vector<int> mHullEdges;
+        std::vector<int> mStack;
+
+        static int Next(int edge) { return edge % 3 == 2 ? edge - 2 : edge + 1; }
+        static int Prev(int edge) { return edge % 3 == 0 ? edge + 2 : edge - 1; }
+
+        // Twice the signed area of (a, b, c): positive when c lies left of a -> b.
+        double Orient(int a, int b, int c) const {
+            const std::vector<ProjectedPoint>& p = *mPoints;
+            return (p[b].mX - p[a].mX) * (p[c].mY - p[a].mY) - (p[b].mY - p[a].mY) * (p[c].mX - p[a].mX);
+        }
+
+        // True when d lies inside the circle through the counterclockwise triangle (a, b, c).
+        bool InCircle(int a, int b, int c, int d) const {
+            const std::vector<ProjectedPoint>& p = *mPoints;
+            double ax = p[a].mX - p[d].mX, ay = p[a].mY - p[d].mY;
+            double bx = p[b].mX - p[d].mX, by = p[b].mY - p[d].mY;
+            double cx = p[c].mX - p[d].mX, cy = p[c].mY - p[d].mY;
+            double a2 = ax * ax + ay * ay;
+            double b2 = bx * bx + by * by;
+            double c2 = cx * cx + cy * cy;
+            return ax * (by * c2 - b2 * cy) - ay * (bx * c2 - b2 * cx) + a2 * (bx * cy - by * cx) > 0;
+        }
+
+        void Link(int edge, int twin) {
+            mTwins[edge] = twin;
+            if (twin >= 0) {
+                mTwins[twin] = edge;
+            }
+            else {
+                mHullEdges[mStarts[edge]] = edge;
+            }
+        }
+
+        // Function that appends the counterclockwise triangle (a, b, c) with the given twins of a -> b, b -> c and
+        // c -> a, and returns its first half-edge.
+        int AddTriangle(int a, int b, int c, int twinA, int twinB, int twinC) {
+            int t = static_cast<int>(mStarts.size());
+            mStarts.push_back(a);
+            mStarts.push_back(b);
+            mStarts.push_back(c);
+            mTwins.resize(t + 3);
+            Link(t, twinA);
+            Link(t + 1, twinB);
+            Link(t + 2, twinC);
+            return t;
+        }
+
+        // Function that flips edges until the triangles around a new point are Delaunay again. Every edge on the stack
+        // has the new point opposite to it, at the start of the previous half-edge.
+        void Legalize(int edge) {
+            mStack.assign(1, edge);
+            while (!mStack.empty()) {
+                int a = mStack.back();
+                mStack.pop_back();
+                int b = mTwins[a];
+                if (b < 0) {
+                    continue;
+                }
+                int al = Next(a);
+                int ar = Prev(a);
+                int bl = Prev(b);
+                int br = Next(b);
+                int p0 = mStarts[ar];
+                int pr = mStarts[a];
+                int pl = mStarts[al];
+                int p1 = mStarts[bl];
+                if (!InCircle(pr, pl, p0, p1)) {
+                    continue;
+                }
+                // Replace the diagonal pr-pl of the quadrilateral pr, p1, pl, p0 by p0-p1.
+                mStarts[a] = p1;
+                mStarts[b] = p0;
+                int twinBl = mTwins[bl];
+                int twinAr = mTwins[ar];
+                Link(a, twinBl);
+                Link(b, twinAr);
+                Link(ar, bl);
+                mStack.push_back(a);
+                mStack.push_back(br);
+            }
+        }
+    };
+
+    // Function that returns a number in [0, 1) that grows with the angle of (dx, dy), cheaper than atan2.
+    double PseudoAngle(double dx, double dy) {
+        double p = dx / (std::abs(dx) + std::abs(dy));
+        return (dy > 0 ? 3 - p : 1 + p) / 4;
+    }
+}
+
+void DelaunayEdges(const std::vector<ProjectedPoint>& points, std::vector<std::pair<int,int>>& edges) {
+    int size = static_cast<int>(points.size());
+    edges.clear();
+    if (size < 2) {
+        return;
+    }
+
+    // Locations at the same coordinates are triangulated once, through the first of them.
+    std::vector<int> order(size);
+    for (int i = 0; i < size; i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&points](int a, int b) {
+        return points[a].mX < points[b].mX || (points[a].mX == points[b].mX && (points[a].mY < points[b].mY || (points[a].mY == points[b].mY && a < b)));
+    });
+    std::vector<int> representative(size);
+    std::vector<int> distinct;
+    for (int i = 0; i < size; i++) {
+        bool same = i > 0 && points[order[i]].mX == points[order[i - 1]].mX && points[order[i]].mY == points[order[i - 1]].mY;
+        representative[order[i]] = same ? representative[order[i - 1]] : order[i];
+        if (!same) {
+            distinct.push_back(order[i]);
+        }
+    }
+
+    // The seed triangle: the point nearest the center of the bounding box, the point nearest to it, and the point that
+    // makes the smallest circle with both.
+    double minX = points[0].mX, maxX = points[0].mX, minY = points[0].mY, maxY = points[0].mY;
+    for (const ProjectedPoint& point : points) {
+        minX = std::min(minX, point.mX);
+        maxX = std::max(maxX, point.mX);
+        minY = std::min(minY, point.mY);
+        maxY = std::max(maxY, point.mY);
+    }
+    auto squared = [&points](int a, double x, double y) {
+        return (points[a].mX - x) * (points[a].mX - x) + (points[a].mY - y) * (points[a].mY - y);
+    };
+    int i0 = distinct[0];
+    for (int city : distinct) {
+        if (squared(city, (minX + maxX) / 2, (minY + maxY) / 2) < squared(i0, (minX + maxX) / 2, (minY + maxY) / 2)) {
+            i0 = city;
+        }
+    }
+    int i1 = -1;
+    for (int city : distinct) {
+        if (city != i0 && (i1 < 0 || squared(city, points[i0].mX, points[i0].mY) < squared(i1, points[i0].mX, points[i0].mY))) {
+            i1 = city;
+        }
+    }
+    int i2 = -1;
+    double centerX = 0.0, centerY = 0.0, smallest = 0.0;
+    for (int city : distinct) {
+        if (city == i0 || city == i1) {
+            continue;
+        }
+        double bx = points[i1].mX - points[i0].mX, by = points[i1].mY - points[i0].mY;
+        double cx = points[city].mX - points[i0].mX, cy = points[city].mY - points[i0].mY;
+        double d = 2 * (bx * cy - by * cx);
+        if (d == 0) {
+            continue;
+        }
+        double b2 = bx * bx + by * by, c2 = cx * cx + cy * cy;
+        double x = (cy * b2 - by * c2) / d;
+        double y = (bx * c2 - cx * b2) / d;
+        if (i2 < 0 || x * x + y * y < smallest) {
+            i2 = city;
+            smallest = x * x + y * y;
+            centerX = points[i0].mX + x;
+            centerY = points[i0].mY + y;
+        }
+    }
+
+    if (i2 < 0) {
+        // Every point on one line: the edges join neighbors along it.
+        for (size_t i = 1; i < distinct.size(); i++) {
+            edges.emplace_back(std::min(distinct[i - 1], distinct[i]), std::max(distinct[i - 1], distinct[i]));
+        }
+    }
+    else {
+        Triangulation triangulation;
+        triangulation.mPoints = &points;
+        triangulation.mHullEdges.assign(size, -1);
+        triangulation.mStarts.reserve(6 * distinct.size());
+        triangulation.mTwins.reserve(6 * distinct.size());
+        if (triangulation.Orient(i0, i1, i2) < 0) {
+            std::swap(i1, i2);
+        }
+
+        // The hull as a counterclockwise linked list, with a hash on the angle around the center to find a hull point
+        // near a new point quickly.
+        std::vector<int> hullNext(size, -1);
+        std::vector<int> hullPrev(size, -1);
+        int hashSize = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(distinct.size()))));
+        std::vector<int> hullHash(hashSize, -1);
+        auto hashKey = [&](int city) {
+            int key = static_cast<int>(std::floor(PseudoAngle(points[city].mX - centerX, points[city].mY - centerY) * hashSize));
+            return std::min(std::max(key, 0), hashSize - 1);
+        };
+        hullNext[i0] = i1;
+        hullNext[i1] = i2;
+        hullNext[i2] = i0;
+        hullPrev[i1] = i0;
+        hullPrev[i2] = i1;
+        hullPrev[i0] = i2;
+        hullHash[hashKey(i0)] = i0;
+        hullHash[hashKey(i1)] = i1;
+        hullHash[hashKey(i2)] = i2;
+        triangulation.AddTriangle(i0, i1, i2, -1, -1, -1);
+
+        // Add the points from the seed's circle outwards; each one lies outside the hull so far and joins every hull
+        // edge it can see.
+        std::sort(distinct.begin(), distinct.end(), [&](int a, int b) {
+            double da = squared(a, centerX, centerY);
+            double db = squared(b, centerX, centerY);
+            return da < db || (da == db && a < b);
+        });
+        for (int city : distinct) {
+            if (city == i0 || city == i1 || city == i2) {
+                continue;
+            }
+            int key = hashKey(city);
+            int start = -1;
+            for (int j = 0; j < hashSize; j++) {
+                start = hullHash[(key + j) % hashSize];
+                if (start >= 0 && hullNext[start] != start) {
+                    break;
+                }
+            }
+            start = hullPrev[start];
+            int e = start;
+            while (triangulation.Orient(e, hullNext[e], city) >= 0) {
+                e = hullNext[e];
+                if (e == start) {
+                    e = -1;
+                    break;
+                }
+            }
+            if (e < 0) {
+                // Only rounding can put a point inside the hull; it is left out of the triangulation.
+                continue;
+            }
+
+            int t = triangulation.AddTriangle(e, city, hullNext[e], -1, -1, triangulation.mHullEdges[e]);
+            triangulation.Legalize(t + 2);
+
+            // Walk forward along the hull while the point sees the edges, then backward.
+            int n = hullNext[e];
+            int q = hullNext[n];
+            while (triangulation.Orient(n, q, city) < 0) {
+                t = triangulation.AddTriangle(n, city, q, triangulation.mHullEdges[city], -1, triangulation.mHullEdges[n]);
+                triangulation.Legalize(t + 2);
+                hullNext[n] = n;
+                n = q;
+                q = hullNext[n];
+            }
+            if (e == start) {
+                q = hullPrev[e];
+                while (triangulation.Orient(q, e, city) < 0) {
+                    t = triangulation.AddTriangle(q, city, e, -1, triangulation.mHullEdges[e], triangulation.mHullEdges[q]);
+                    triangulation.Legalize(t + 2);
+                    hullNext[e] = e;
+                    e = q;
+                    q = hullPrev[e];
+                }
+            }
+
+            hullPrev[city] = e;
+            hullNext[e] = city;
+            hullPrev[n] = city;
+            hullNext[city] = n;
+            hullHash[hashKey(city)] = city;
+            hullHash[hashKey(e)] = e;
+        }
+
+        // Every triangulated edge, once: from its hull half-edge or the later of its two half-edges
+        for (int edge = 0; edge < static_cast<int>(triangulation.mStarts.size()); edge++) {
+            int a = triangulation.mStarts[edge];
+            int b = triangulation.mStarts[Triangulation::Next(edge)];
+            if (triangulation.mTwins[edge] < edge) {
+                edges.emplace_back(std::min(a, b), std::max(a, b));
+            }
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    // The other locations at the same coordinates: an edge to the representative, and its Delaunay neighbors.
+    size_t triangulated = edges.size();
+    std::vector<int> offsets(size + 1, 0);
+    for (size_t i = 0; i < triangulated; i++) {
+        offsets[edges[i].first + 1]++;
+        offsets[edges[i].second + 1]++;
+    }
+    for (int city = 0; city < size; city++) {
+        offsets[city + 1] += offsets[city];
+    }
+    std::vector<int> neighbors(offsets[size]);
+    std::vector<int> cursors(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < triangulated; i++) {
+        neighbors[cursors[edges[i].first]++] = edges[i].second;
+        neighbors[cursors[edges[i].second]++] = edges[i].first;
+    }
+    bool duplicates = false;
+    for (int city = 0; city < size; city++) {
+        int first = representative[city];
+        if (first == city) {
+            continue;
+        }
+        duplicates = true;
+        edges.emplace_back(first, city);
+        for (int i = offsets[first]; i < offsets[first + 1]; i++) {
+            edges.emplace_back(std::min(neighbors[i], city), std::max(neighbors[i], city));
+        }
+    }
+    if (duplicates) {
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    }
+}
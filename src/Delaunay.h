@@ -0,0 +1,15 @@
+#pragma once
+#include <utility>
+#include <vector>
+#include "Distance.h"
+
+// Delaunay triangulation of the projected locations, used for candidate edges: unlike the k nearest neighbors, its edges
+// always connect a cluster to the clusters next to it, and a city has about 6 of them on average. It is built by a
+// sweep from a seed triangle: the points are added in order of distance from the seed's circle, so each new one lies
+// outside the hull so far and is joined to the hull edges it can see, after which edges that break the empty circle
+// rule are flipped (Lawson). A hash on the angle around the seed finds the hull near each point, so the whole
+// triangulation takes about O(N log N). Locations at the same coordinates are triangulated once and get an edge to
+// each other and the same Delaunay neighbors.
+
+// Function that writes the edges of the Delaunay triangulation as (smaller city, larger city) pairs, each one once.
+void DelaunayEdges(const std::vector<ProjectedPoint>& points, std::vector<std::pair<int,int>>& edges);
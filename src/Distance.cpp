@@ -0,0 +1,233 @@
+#include "Distance.h"
+#include "Delaunay.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+std::vector<ProjectedPoint> ProjectLocations(const std::vector<Location>& locations) {
+    double meanLatitude = 0.0;
+    for (const Location& location : locations) {
+        meanLatitude += location.mLatitude;
+    }
+    if (!locations.empty()) {
+        meanLatitude /= static_cast<double>(locations.size());
+    }
+    double scale = cos(meanLatitude * 0.0174533);
+
+    std::vector<ProjectedPoint> points(locations.size());
+    for (size_t i = 0; i < locations.size(); i++) {
+        points[i].mX = locations[i].mLongitude * scale;
+        points[i].mY = locations[i].mLatitude;
+    }
+    return points;
+}
+
+DistanceStore::DistanceStore(const std::vector<Location>& locations) : mSize(locations.size()), mTree(locations), mPoints(ProjectLocations(locations)) {
+    // Convert the coordinates once, the same way GetHaversineDistance does.
+    mLatRad.resize(mSize);
+    mLonRad.resize(mSize);
+    mCosLat.resize(mSize);
+    for (size_t i = 0; i < mSize; i++) {
+        mLatRad[i] = locations[i].mLatitude * 0.0174533;
+        mLonRad[i] = locations[i].mLongitude * 0.0174533;
+        mCosLat[i] = cos(mLatRad[i]);
+    }
+
+    // Small instances get the full matrix.
+    FillMatrix();
+}
+
+DistanceStore::DistanceStore(const std::vector<Location>& locations, DistanceMetric metric, std::vector<ProjectedPoint> coordinates)
+    : mSize(locations.size()), mMetric(metric), mCoordinates(std::move(coordinates)), mTree(locations), mPoints(ProjectLocations(locations)) {
+    if (metric == DistanceMetric::Haversine || metric == DistanceMetric::Explicit || mCoordinates.size() != mSize) {
+        throw std::invalid_argument("A TSPLIB distance function needs one coordinate pair per location");
+    }
+    FillMatrix();
+}
+
+DistanceStore::DistanceStore(const std::vector<Location>& locations, std::vector<double> matrix)
+    : mSize(locations.size()), mMetric(DistanceMetric::Explicit), mMatrix(std::move(matrix)), mTree(locations), mPoints(ProjectLocations(locations)) {
+    if (mMatrix.size() != mSize * mSize) {
+        throw std::invalid_argument("The distance matrix must have one row and one column per location");
+    }
+}
+
+// Function that computes the full matrix for instances up to sDenseLimit locations.
+void DistanceStore::FillMatrix() {
+    if (mSize <= sDenseLimit) {
+        mMatrix.resize(mSize * mSize);
+        for (size_t a = 0; a < mSize; a++) {
+            for (size_t b = 0; b < mSize; b++) {
+                mMatrix[a * mSize + b] = Compute(static_cast<int>(a), static_cast<int>(b));
+            }
+        }
+    }
+}
+
+// Function that computes the Haversine distance between two locations, step for step like GetHaversineDistance.
+double DistanceStore::Compute(int a, int b) const {
+    if (mMetric != DistanceMetric::Haversine) {
+        return ComputeTspLib(a, b);
+    }
+    double dlon = mLonRad[a] - mLonRad[b];
+    double dlat = mLatRad[a] - mLatRad[b];
+    double h = pow((sin(dlat/2)), 2) + mCosLat[a] * mCosLat[b] * pow((sin(dlon/2)),2);
+    double c = 2 * atan2( sqrt(h), sqrt(1-h) );
+    return 3961 * c;
+}
+
+// Function that computes a TSPLIB distance, exactly as the TSPLIB documentation defines it (nint is rounding to the
+// nearest integer).
+double DistanceStore::ComputeTspLib(int a, int b) const {
+    double dx = mCoordinates[a].mX - mCoordinates[b].mX;
+    double dy = mCoordinates[a].mY - mCoordinates[b].mY;
+    if (mMetric == DistanceMetric::Euclidean) {
+        return static_cast<int>(sqrt(dx * dx + dy * dy) + 0.5);
+    }
+    if (mMetric == DistanceMetric::Att) {
+        double r = sqrt((dx * dx + dy * dy) / 10.0);
+        int t = static_cast<int>(r + 0.5);
+        return t < r ? t + 1 : t;
+    }
+
+    // GEO: x is the latitude and y the longitude, as degrees and minutes, on a sphere of radius 6378.388 km.
+    if (a == b) {
+        return 0.0;
+    }
+    auto radians = [](double value) {
+        const double pi = 3.141592;
+        int degrees = static_cast<int>(value);
+        return pi * (degrees + 5.0 * (value - degrees) / 3.0) / 180.0;
+    };
+    double latitudeA = radians(mCoordinates[a].mX), longitudeA = radians(mCoordinates[a].mY);
+    double latitudeB = radians(mCoordinates[b].mX), longitudeB = radians(mCoordinates[b].mY);
+    double q1 = cos(longitudeA - longitudeB);
+    double q2 = cos(latitudeA - latitudeB);
+    double q3 = cos(latitudeA + latitudeB);
+    return static_cast<int>(6378.388 * acos(0.5 * ((1.0 + q1) * q2 - (1.0 - q1) * q3)) + 1.0);
+}
+
+double DistanceStore::TourLength(const std::vector<int>& tour) const {
+    if (tour.empty()) {
+        return 0.0;
+    }
+    double length = Get(tour.back(), tour.front());
+    for (size_t i = 1; i < tour.size(); i++) {
+        length += Get(tour[i - 1], tour[i]);
+    }
+    return length;
+}
+
+void DistanceStore::BuildCandidates(int k, CandidateSet set) {
+    mCandidateCount = std::min(k, static_cast<int>(mSize) - 1);
+    mCandidates.assign(mSize * mCandidateCount, 0);
+    if (mMetric == DistanceMetric::Explicit) {
+        BuildMatrixCandidates();
+        return;
+    }
+    if (set != CandidateSet::Nearest) {
+        BuildDelaunayCandidates(set == CandidateSet::DelaunayQuadrant);
+        return;
+    }
+
+    // For every location, ask the KD-tree for the nearest ones. The chord lengths order them like the Haversine distance
+    // up to rounding, so they are sorted once more by the distances the operators see.
+    std::vector<std::pair<double,int>> nearest;
+    for (size_t city = 0; city < mSize; city++) {
+        mTree.Nearest(static_cast<int>(city), mCandidateCount, nearest);
+        for (auto& neighbor : nearest) {
+            neighbor.first = Get(static_cast<int>(city), neighbor.second);
+        }
+        std::stable_sort(nearest.begin(), nearest.end(), [](const std::pair<double,int>& a, const std::pair<double,int>& b) {
+            return a.first < b.first;
+        });
+        for (int i = 0; i < mCandidateCount; i++) {
+            mCandidates[city * mCandidateCount + i] = nearest[i].second;
+        }
+    }
+}
+
+// Function that fills the candidate lists with the nearest locations by the matrix, ties broken by index.
+void DistanceStore::BuildMatrixCandidates() {
+    std::vector<std::pair<double,int>> others;
+    for (size_t city = 0; city < mSize; city++) {
+        others.clear();
+        for (size_t other = 0; other < mSize; other++) {
+            if (other != city) {
+                others.emplace_back(Get(static_cast<int>(city), static_cast<int>(other)), static_cast<int>(other));
+            }
+        }
+        std::partial_sort(others.begin(), others.begin() + mCandidateCount, others.end());
+        for (int i = 0; i < mCandidateCount; i++) {
+            mCandidates[city * mCandidateCount + i] = others[i].second;
+        }
+    }
+}
+
+// Function that fills the candidate lists from the Delaunay triangulation (plus the quadrant neighbors), topped up with
+// the nearest locations.
+void DistanceStore::BuildDelaunayCandidates(bool quadrants) {
+    int size = static_cast<int>(mSize);
+    std::vector<std::pair<int,int>> edges;
+    DelaunayEdges(mPoints, edges);
+    std::vector<int> offsets(size + 1, 0);
+    for (const auto& edge : edges) {
+        offsets[edge.first + 1]++;
+        offsets[edge.second + 1]++;
+    }
+    for (int city = 0; city < size; city++) {
+        offsets[city + 1] += offsets[city];
+    }
+    std::vector<int> neighbors(offsets[size]);
+    std::vector<int> cursors(offsets.begin(), offsets.end() - 1);
+    for (const auto& edge : edges) {
+        neighbors[cursors[edge.first]++] = edge.second;
+        neighbors[cursors[edge.second]++] = edge.first;
+    }
+
+    std::vector<std::pair<double,int>> chosen;
+    std::vector<std::pair<double,int>> nearest;
+    for (int city = 0; city < size; city++) {
+        chosen.clear();
+        for (int i = offsets[city]; i < offsets[city + 1]; i++) {
+            chosen.emplace_back(Get(city, neighbors[i]), neighbors[i]);
+        }
+        auto contains = [&chosen](int other) {
+            return std::any_of(chosen.begin(), chosen.end(), [other](const std::pair<double,int>& entry) {
+                return entry.second == other;
+            });
+        };
+
+        // The nearest of the 4k nearest locations in each quadrant (by the signs of the projected offsets)
+        mTree.Nearest(city, 4 * mCandidateCount, nearest);
+        if (quadrants) {
+            bool taken[4] = { false, false, false, false };
+            for (const auto& neighbor : nearest) {
+                int other = neighbor.second;
+                int quadrant = (mPoints[other].mX >= mPoints[city].mX ? 1 : 0) + (mPoints[other].mY >= mPoints[city].mY ? 2 : 0);
+                if (!taken[quadrant]) {
+                    taken[quadrant] = true;
+                    if (!contains(other)) {
+                        chosen.emplace_back(Get(city, other), other);
+                    }
+                }
+            }
+        }
+        std::sort(chosen.begin(), chosen.end());
+        if (static_cast<int>(chosen.size()) > mCandidateCount) {
+            chosen.resize(mCandidateCount);
+        }
+
+        // Fill the remaining places with the nearest locations that are not in yet.
+        for (size_t i = 0; i < nearest.size() && static_cast<int>(chosen.size()) < mCandidateCount; i++) {
+            if (!contains(nearest[i].second)) {
+                chosen.emplace_back(Get(city, nearest[i].second), nearest[i].second);
+            }
+        }
+        std::sort(chosen.begin(), chosen.end());
+        for (int i = 0; i < mCandidateCount; i++) {
+            mCandidates[static_cast<size_t>(city) * mCandidateCount + i] = chosen[i].second;
+        }
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <vector>
+#include "TSP.h"
+#include "KdTree.h"
+
+// A location projected onto a plane, in degrees: x is the longitude scaled by the cosine of the mean latitude and y is
+// the latitude, so that nearby locations are about as far apart as on the globe.
+struct ProjectedPoint
+{
+	double mX = 0.0;
+	double mY = 0.0;
+};
+
+// Function that projects the locations with an equirectangular projection centered on their mean latitude.
+std::vector<ProjectedPoint> ProjectLocations(const std::vector<Location>& locations);
+
+// How the distance between two locations is measured: the Haversine distance of the input files, or one of the TSPLIB
+// distance functions (rounded to integers as TSPLIB defines them) on the coordinates of a .tsp file, or a given matrix.
+enum class DistanceMetric
+{
+	Haversine,
+	Euclidean,  // TSPLIB EUC_2D
+	Geographic, // TSPLIB GEO, with coordinates in DDD.MM degrees and minutes
+	Att,        // TSPLIB ATT pseudo-Euclidean
+	Explicit    // TSPLIB EXPLICIT matrix
+};
+
+// The distances between locations, shared by every operator that looks at edge lengths. Small instances keep the full
+// matrix; bigger ones compute the Haversine distance on demand from coordinates that are converted once. Either way a
+// distance is exactly what GetHaversineDistance returns for the two locations (TSPLIB instances use their own distance
+// function instead). A KD-tree over the locations is built with the store and answers the nearest-neighbor queries.
+class DistanceStore
+{
+public:
+	// Instances up to this many locations keep the full matrix (32 MB of doubles at the limit).
+	static constexpr size_t sDenseLimit = 2048;
+
+	explicit DistanceStore(const std::vector<Location>& locations);
+
+	// A store for a TSPLIB distance function on the file's coordinates (one point per location, x and y as in the
+	// file). The locations only serve the KD-tree and the projections, so they may be any placement of the points that
+	// keeps neighbors close.
+	DistanceStore(const std::vector<Location>& locations, DistanceMetric metric, std::vector<ProjectedPoint> coordinates);
+
+	// A store for a full, symmetric matrix of size locations.size() squared, kept whatever the size. The candidate
+	// lists come straight from the matrix.
+	DistanceStore(const std::vector<Location>& locations, std::vector<double> matrix);
+
+	size_t Size() const { return mSize; }
+
+	DistanceMetric Metric() const { return mMetric; }
+
+	// The TSPLIB coordinates of the locations (empty for the Haversine distance and an explicit matrix)
+	const std::vector<ProjectedPoint>& Coordinates() const { return mCoordinates; }
+
+	double Get(int a, int b) const
+	{
+		if (!mMatrix.empty())
+		{
+			return mMatrix[static_cast<size_t>(a) * mSize + b];
+		}
+		return Compute(a, b);
+	}
+
+	// Length of the round trip through the tour (including the edge back to the first location).
+	double TourLength(const std::vector<int>& tour) const;
+
+	// The spatial index over the locations
+	const KdTree& Tree() const { return mTree; }
+
+	// Builds the candidate lists: k other locations for every location, nearest first. With Nearest they are the k
+	// nearest ones, in O(N k log N) with the KD-tree. The Delaunay sets keep a location's Delaunay neighbors (and the
+	// nearest location in each quadrant around it) and fill the rest of the k places with the nearest locations, so a
+	// list only drops a Delaunay edge when the location has more than k of them; those lists take O(N log N) more. An
+	// explicit matrix has no geometry: its lists are the k nearest by the matrix whatever the set, in O(N^2 log k).
+	void BuildCandidates(int k, CandidateSet set = CandidateSet::Nearest);
+
+	int CandidateCount() const { return mCandidateCount; }
+
+	// The candidate neighbors of a location (CandidateCount() of them).
+	const int* Candidates(int city) const { return mCandidates.data() + static_cast<size_t>(city) * mCandidateCount; }
+
+private:
+	double Compute(int a, int b) const;
+	double ComputeTspLib(int a, int b) const;
+	void BuildDelaunayCandidates(bool quadrants);
+	void BuildMatrixCandidates();
+	void FillMatrix();
+
+	size_t mSize = 0;
+	DistanceMetric mMetric = DistanceMetric::Haversine;
+	std::vector<ProjectedPoint> mCoordinates; // TSPLIB coordinates
+	std::vector<double> mMatrix;
+	std::vector<double> mLatRad;
+	std::vector<double> mLonRad;
+	std::vector<double> mCosLat;
+	KdTree mTree;
+	std::vector<ProjectedPoint> mPoints;
+	int mCandidateCount = 0;
+	std::vector<int> mCandidates;
+};
@@ -0,0 +1,101 @@
+#include "Diversity.h"
+#include <algorithm>
+#include <fstream>
+
+DiversityMetrics MeasureDiversity(const Population& pop, DiversityScratch& scratch) {
+    DiversityMetrics metrics;
+    if (pop.mMembers.empty() || pop.mMembers[0].size() < 3) {
+        metrics.mUniqueTours = static_cast<int>(pop.mMembers.size());
+        return metrics;
+    }
+    size_t size = pop.mMembers[0].size();
+    size_t members = pop.mMembers.size();
+    std::vector<uint64_t>& keys = scratch.mKeys;
+
+    // Unique tours: hash every cycle read from location 0 in the direction whose second city is smaller, so a tour and
+    // its reversal hash alike, and count the distinct hashes.
+    keys.clear();
+    for (const auto& tour : pop.mMembers) {
+        bool reversed = tour[1] > tour[size - 1];
+        uint64_t hash = 0;
+        for (size_t i = 0; i < size; i++) {
+            hash = MixBits(hash + static_cast<uint64_t>(tour[reversed ? (size - i) % size : i]));
+        }
+        keys.push_back(hash);
+    }
+    std::sort(keys.begin(), keys.end());
+    metrics.mUniqueTours = static_cast<int>(std::unique(keys.begin(), keys.end()) - keys.begin());
+
+    // Edge frequencies: every undirected edge is filed under its smaller city by a counting sort, and each city's bucket is
+    // counted with a stamp per neighbor, so the whole pass is linear in N P.
+    std::vector<int>& offsets = scratch.mOffsets;
+    std::vector<int>& neighbors = scratch.mNeighbors;
+    offsets.assign(size + 1, 0);
+    for (const auto& tour : pop.mMembers) {
+        for (size_t i = 0; i < size; i++) {
+            int a = tour[i];
+            int b = tour[i + 1 == size ? 0 : i + 1];
+            ++offsets[std::min(a, b) + 1];
+        }
+    }
+    for (size_t city = 0; city < size; city++) {
+        offsets[city + 1] += offsets[city];
+    }
+    neighbors.resize(size * members);
+    std::vector<int>& fill = scratch.mCursors;
+    fill.assign(offsets.begin(), offsets.end() - 1);
+    for (const auto& tour : pop.mMembers) {
+        for (size_t i = 0; i < size; i++) {
+            int a = tour[i];
+            int b = tour[i + 1 == size ? 0 : i + 1];
+            neighbors[fill[std::min(a, b)]++] = std::max(a, b);
+        }
+    }
+
+    std::vector<int>& stamps = scratch.mStamps;
+    std::vector<int>& counts = scratch.mCounts;
+    stamps.assign(size, -1);
+    counts.assign(size, 0);
+    int shared = 0;
+    for (size_t city = 0; city < size; city++) {
+        for (int k = offsets[city]; k < offsets[city + 1]; k++) {
+            int other = neighbors[k];
+            if (stamps[other] != static_cast<int>(city)) {
+                stamps[other] = static_cast<int>(city);
+                counts[other] = 0;
+                ++metrics.mDistinctEdges;
+            }
+            // Count the edge once, when more than half of the members have been seen using it.
+            if (2 * ++counts[other] > static_cast<int>(members) && 2 * (counts[other] - 1) <= static_cast<int>(members)) {
+                ++shared;
+            }
+        }
+    }
+    metrics.mSharedEdges = static_cast<double>(shared) / metrics.mDistinctEdges;
+
+    // At most N P distinct edges, and never more than the complete graph has.
+    double most = std::min(static_cast<double>(size) * members, static_cast<double>(size) * (size - 1) / 2.0);
+    if (most > size) {
+        metrics.mEdgeDiversity = std::clamp((metrics.mDistinctEdges - static_cast<double>(size)) / (most - size), 0.0, 1.0);
+    }
+    return metrics;
+}
+
+int AdaptMutationChance(const DiversityMetrics& metrics, int popSize, int mutationChanceInt, const GAOptions& options) {
+    double uniqueFraction = popSize > 0 ? static_cast<double>(metrics.mUniqueTours) / popSize : 1.0;
+    int chance = mutationChanceInt;
+    if (uniqueFraction < 0.5 || metrics.mEdgeDiversity < 0.05) {
+        chance += std::max(1, chance / 4);
+    }
+    else {
+        chance -= std::max(1, chance / 5);
+    }
+    return std::clamp(chance, options.mMutationMin, options.mMutationMax);
+}
+
+void OutputDiversity(std::string_view fileName, const DiversityMetrics& metrics, int mutationChanceInt) {
+    std::ofstream out(fileName.data(), std::ios_base::app);
+    out << "DIVERSITY: unique tours " << metrics.mUniqueTours << ", distinct edges " << metrics.mDistinctEdges
+        << ", edge diversity " << metrics.mEdgeDiversity << ", shared edges " << metrics.mSharedEdges
+        << ", mutation chance " << mutationChanceInt << '\n';
+}
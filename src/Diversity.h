@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "TSP.h"
+
+// Cheap measures of how varied a population still is, taken once per generation to steer the mutation chance.
+
+struct DiversityMetrics
+{
+	int mUniqueTours = 0; // members that are not the same cycle as an earlier member (in either direction)
+	int mDistinctEdges = 0; // undirected edges used by at least one member
+	double mEdgeDiversity = 0.0; // (distinct edges - N) / (most possible - N): 0 when every member has the same edges, 1 when no two share one
+	double mSharedEdges = 0.0; // fraction of the distinct edges that more than half of the members use
+};
+
+// Scratch buffers reused across generations
+struct DiversityScratch
+{
+	std::vector<uint64_t> mKeys;
+	std::vector<int> mOffsets;
+	std::vector<int> mNeighbors;
+	std::vector<int> mCursors;
+	std::vector<int> mStamps;
+	std::vector<int> mCounts;
+};
+
+// Function that measures the population in O(N P): one hash per member, and one counting pass over every member's edges.
+DiversityMetrics MeasureDiversity(const Population& pop, DiversityScratch& scratch);
+
+// Function that moves the mutation chance (in percent) one step: up by a quarter when the population is converging (fewer
+// than half of the members unique or an edge diversity below 0.05), and otherwise down by a fifth, so the chance settles
+// as low as the population's diversity allows. The result stays within the options' bounds.
+int AdaptMutationChance(const DiversityMetrics& metrics, int popSize, int mutationChanceInt, const GAOptions& options);
+
+// Function that logs the metrics of a generation and the mutation chance chosen for it.
+void OutputDiversity(std::string_view fileName, const DiversityMetrics& metrics, int mutationChanceInt);
@@ -0,0 +1,332 @@
+#include "EAX.h"
+#include "Rng.h"
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+namespace
+{
+    const int sNone = -1;
+
+    // Function that removes the edge to other from the GAB edges of city (edges holds two slots per city).
+    void RemoveGabEdge(std::vector<int>& edges, std::vector<int>& counts, int city, int other) {
+        int* slots = &edges[2 * city];
+        if (slots[0] == other) {
+            slots[0] = slots[1];
+        }
+        slots[1] = sNone;
+        --counts[city];
+    }
+
+    // Function that replaces the link from city to from by a link to to.
+    void ReplaceLink(std::vector<int>& links, int city, int from, int to) {
+        if (links[2 * city] == from) {
+            links[2 * city] = to;
+        }
+        else {
+            links[2 * city + 1] = to;
+        }
+    }
+
+    // Function that returns the neighbor of city on its subtour that is not prev.
+    int NextOnSubtour(const std::vector<int>& links, int city, int prev) {
+        return links[2 * city] == prev ? links[2 * city + 1] : links[2 * city];
+    }
+}
+
+// Function that builds the AB-cycles: random walks through GAB that alternate between edges of the first parent (A) and
+// of the second parent (B), cutting off a cycle whenever the walk returns to a city with the same parity.
+static void BuildABCycles(size_t size, SplitMix64& generator, EaxScratch& scratch) {
+    scratch.mCycleVertices.clear();
+    scratch.mCycleStarts.clear();
+    scratch.mCycleFirstIsA.clear();
+    scratch.mPathPos.assign(2 * size, sNone);
+
+    while (!scratch.mActive.empty()) {
+        // Pick a random city that still has GAB edges as the start of the next walk.
+        size_t pick = generator() % scratch.mActive.size();
+        int start = scratch.mActive[pick];
+        if (scratch.mCountA[start] == 0) {
+            scratch.mActive[pick] = scratch.mActive.back();
+            scratch.mActive.pop_back();
+            continue;
+        }
+
+        scratch.mPath.assign(1, start);
+        scratch.mPathPos[2 * start] = 0;
+        while (true) {
+            // Edge k of the walk is an A edge when k is even.
+            int last = static_cast<int>(scratch.mPath.size()) - 1;
+            int city = scratch.mPath[last];
+            bool useA = last % 2 == 0;
+            std::vector<int>& edges = useA ? scratch.mEdgesA : scratch.mEdgesB;
+            std::vector<int>& counts = useA ? scratch.mCountA : scratch.mCountB;
+            if (counts[city] == 0) {
+                break;
+            }
+
+            int next = edges[2 * city + generator() % counts[city]];
+            RemoveGabEdge(edges, counts, city, next);
+            RemoveGabEdge(edges, counts, next, city);
+            scratch.mPath.push_back(next);
+
+            int index = last + 1;
+            int& seen = scratch.mPathPos[2 * next + index % 2];
+            if (seen == sNone) {
+                seen = index;
+                continue;
+            }
+
+            // The walk closed an alternating cycle path[seen..index], so cut it off and keep walking from path[seen].
+            int begin = seen;
+            scratch.mCycleStarts.push_back(static_cast<int>(scratch.mCycleVertices.size()));
+            scratch.mCycleFirstIsA.push_back(begin % 2 == 0);
+            for (int k = begin; k < index; k++) {
+                scratch.mCycleVertices.push_back(scratch.mPath[k]);
+                if (k > begin) {
+                    scratch.mPathPos[2 * scratch.mPath[k] + k % 2] = sNone;
+                }
+            }
+            scratch.mPath.resize(begin + 1);
+        }
+
+        // Forget the positions of what is left of the walk.
+        for (size_t k = 0; k < scratch.mPath.size(); k++) {
+            scratch.mPathPos[2 * scratch.mPath[k] + k % 2] = sNone;
+        }
+    }
+    scratch.mCycleStarts.push_back(static_cast<int>(scratch.mCycleVertices.size()));
+}
+
+// Function that merges the subtours of the intermediate solution until one tour is left. The smallest subtour is joined
+// to another one by removing one edge from each and adding the two cheapest reconnecting edges, looking only at the
+// candidate neighbors of the smallest subtour's cities (or at every city when none of them is outside the subtour).
+static void MergeSubtours(const DistanceStore& distances, EaxScratch& scratch) {
+    size_t size = distances.Size();
+    std::vector<int>& links = scratch.mLinks;
+
+    // Label the subtours.
+    scratch.mSubtour.assign(size, sNone);
+    scratch.mSubtourSize.clear();
+    scratch.mSubtourCity.clear();
+    for (size_t startCity = 0; startCity < size; startCity++) {
+        int start = static_cast<int>(startCity);
+        if (scratch.mSubtour[start] != sNone) {
+            continue;
+        }
+        int id = static_cast<int>(scratch.mSubtourSize.size());
+        int count = 0;
+        int prev = links[2 * start];
+        int city = start;
+        do {
+            scratch.mSubtour[city] = id;
+            ++count;
+            int next = NextOnSubtour(links, city, prev);
+            prev = city;
+            city = next;
+        } while (city != start);
+        scratch.mSubtourSize.push_back(count);
+        scratch.mSubtourCity.push_back(start);
+    }
+
+    // A min-heap of (size, subtour). Entries whose size is out of date are skipped when they come up.
+    auto bySize = std::greater<std::pair<int,int>>();
+    scratch.mHeap.clear();
+    for (int id = 0; id < static_cast<int>(scratch.mSubtourSize.size()); id++) {
+        scratch.mHeap.emplace_back(scratch.mSubtourSize[id], id);
+    }
+    std::make_heap(scratch.mHeap.begin(), scratch.mHeap.end(), bySize);
+
+    int subtourCount = static_cast<int>(scratch.mSubtourSize.size());
+    while (subtourCount > 1) {
+        // The smallest subtour that is left.
+        std::pop_heap(scratch.mHeap.begin(), scratch.mHeap.end(), bySize);
+        std::pair<int,int> top = scratch.mHeap.back();
+        scratch.mHeap.pop_back();
+        int smallest = top.second;
+        if (scratch.mSubtourSize[smallest] != top.first) {
+            continue;
+        }
+
+        scratch.mMembers.clear();
+        int start = scratch.mSubtourCity[smallest];
+        int prev = links[2 * start];
+        int city = start;
+        do {
+            scratch.mMembers.push_back(city);
+            int next = NextOnSubtour(links, city, prev);
+            prev = city;
+            city = next;
+        } while (city != start);
+
+        // Find the cheapest way to remove an edge (c, cn) of the subtour and an edge (w, wn) of another subtour and
+        // reconnect them as (c, w) + (cn, wn) or (c, wn) + (cn, w).
+        double bestDelta = 0.0;
+        int bestC = sNone, bestCn = sNone, bestW = sNone, bestWn = sNone;
+        bool bestCross = false;
+        auto consider = [&](int c, int w) {
+            for (int j = 0; j < 2; j++) {
+                int cn = links[2 * c + j];
+                double removed = distances.Get(c, cn);
+                for (int l = 0; l < 2; l++) {
+                    int wn = links[2 * w + l];
+                    double base = removed + distances.Get(w, wn);
+                    double straight = distances.Get(c, w) + distances.Get(cn, wn) - base;
+                    double cross = distances.Get(c, wn) + distances.Get(cn, w) - base;
+                    if (bestC == sNone || straight < bestDelta) {
+                        bestDelta = straight;
+                        bestC = c; bestCn = cn; bestW = w; bestWn = wn;
+                        bestCross = false;
+                    }
+                    if (cross < bestDelta) {
+                        bestDelta = cross;
+                        bestC = c; bestCn = cn; bestW = w; bestWn = wn;
+                        bestCross = true;
+                    }
+                }
+            }
+        };
+        for (int c : scratch.mMembers) {
+            const int* candidates = distances.Candidates(c);
+            for (int k = 0; k < distances.CandidateCount(); k++) {
+                if (scratch.mSubtour[candidates[k]] != smallest) {
+                    consider(c, candidates[k]);
+                }
+            }
+        }
+        if (bestC == sNone) {
+            for (int c : scratch.mMembers) {
+                for (size_t w = 0; w < size; w++) {
+                    if (scratch.mSubtour[w] != smallest) {
+                        consider(c, static_cast<int>(w));
+                    }
+                }
+            }
+        }
+
+        // Reconnect the two subtours.
+        int joinC = bestCross ? bestWn : bestW;
+        int joinCn = bestCross ? bestW : bestWn;
+        ReplaceLink(links, bestC, bestCn, joinC);
+        ReplaceLink(links, bestCn, bestC, joinCn);
+        ReplaceLink(links, joinC, joinCn, bestC);
+        ReplaceLink(links, joinCn, joinC, bestCn);
+
+        int target = scratch.mSubtour[bestW];
+        for (int member : scratch.mMembers) {
+            scratch.mSubtour[member] = target;
+        }
+        scratch.mSubtourSize[target] += scratch.mSubtourSize[smallest];
+        scratch.mSubtourSize[smallest] = 0;
+        scratch.mHeap.emplace_back(scratch.mSubtourSize[target], target);
+        std::push_heap(scratch.mHeap.begin(), scratch.mHeap.end(), bySize);
+        --subtourCount;
+    }
+}
+
+// Function that builds a child with edge assembly crossover.
+void EdgeAssemblyCrossover(const std::vector<int>& first, const std::vector<int>& second, const DistanceStore& distances, EaxStrategy strategy, uint64_t seed, EaxScratch& scratch, std::vector<int>& child) {
+    size_t size = first.size();
+    SplitMix64 generator(seed);
+
+    // Adjacency of both parents.
+    scratch.mNextA.resize(size);
+    scratch.mPrevA.resize(size);
+    scratch.mNextB.resize(size);
+    scratch.mPrevB.resize(size);
+    for (size_t k = 0; k < size; k++) {
+        size_t after = k + 1 < size ? k + 1 : 0;
+        scratch.mNextA[first[k]] = first[after];
+        scratch.mPrevA[first[after]] = first[k];
+        scratch.mNextB[second[k]] = second[after];
+        scratch.mPrevB[second[after]] = second[k];
+    }
+
+    // GAB: the edges of each parent that the other parent does not have.
+    scratch.mEdgesA.assign(2 * size, sNone);
+    scratch.mEdgesB.assign(2 * size, sNone);
+    scratch.mCountA.assign(size, 0);
+    scratch.mCountB.assign(size, 0);
+    scratch.mActive.clear();
+    for (size_t cityIndex = 0; cityIndex < size; cityIndex++) {
+        int city = static_cast<int>(cityIndex);
+        for (int other : { scratch.mPrevA[city], scratch.mNextA[city] }) {
+            if (scratch.mNextB[city] != other && scratch.mPrevB[city] != other) {
+                scratch.mEdgesA[2 * city + scratch.mCountA[city]++] = other;
+            }
+        }
+        for (int other : { scratch.mPrevB[city], scratch.mNextB[city] }) {
+            if (scratch.mNextA[city] != other && scratch.mPrevA[city] != other) {
+                scratch.mEdgesB[2 * city + scratch.mCountB[city]++] = other;
+            }
+        }
+        if (scratch.mCountA[city] > 0) {
+            scratch.mActive.push_back(city);
+        }
+    }
+
+    // Identical parents have no AB-cycles, so the child is the first parent.
+    if (scratch.mActive.empty()) {
+        child.assign(first.begin(), first.end());
+        return;
+    }
+
+    BuildABCycles(size, generator, scratch);
+    int cycleCount = static_cast<int>(scratch.mCycleStarts.size()) - 1;
+
+    // Pick the E-set.
+    scratch.mESet.clear();
+    if (strategy == EaxStrategy::Random) {
+        for (int cycle = 0; cycle < cycleCount; cycle++) {
+            if (generator() & 1) {
+                scratch.mESet.push_back(cycle);
+            }
+        }
+    }
+    if (scratch.mESet.empty()) {
+        scratch.mESet.push_back(static_cast<int>(generator() % cycleCount));
+    }
+
+    // Start from the first parent, then take out the A edges and put in the B edges of the E-set.
+    scratch.mLinks.resize(2 * size);
+    for (size_t city = 0; city < size; city++) {
+        scratch.mLinks[2 * city] = scratch.mPrevA[city];
+        scratch.mLinks[2 * city + 1] = scratch.mNextA[city];
+    }
+    for (int pass = 0; pass < 2; pass++) {
+        bool removeA = pass == 0;
+        for (int cycle : scratch.mESet) {
+            int begin = scratch.mCycleStarts[cycle];
+            int length = scratch.mCycleStarts[cycle + 1] - begin;
+            for (int k = 0; k < length; k++) {
+                bool isA = (k % 2 == 0) == static_cast<bool>(scratch.mCycleFirstIsA[cycle]);
+                if (isA != removeA) {
+                    continue;
+                }
+                int u = scratch.mCycleVertices[begin + k];
+                int v = scratch.mCycleVertices[begin + (k + 1) % length];
+                if (removeA) {
+                    ReplaceLink(scratch.mLinks, u, v, sNone);
+                    ReplaceLink(scratch.mLinks, v, u, sNone);
+                }
+                else {
+                    ReplaceLink(scratch.mLinks, u, sNone, v);
+                    ReplaceLink(scratch.mLinks, v, sNone, u);
+                }
+            }
+        }
+    }
+
+    MergeSubtours(distances, scratch);
+
+    // Walk the tour from location 0.
+    child.resize(size);
+    int prev = scratch.mLinks[0];
+    int city = 0;
+    for (size_t k = 0; k < size; k++) {
+        child[k] = city;
+        int next = NextOnSubtour(scratch.mLinks, city, prev);
+        prev = city;
+        city = next;
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "Distance.h"
+
+// Edge assembly crossover (EAX). The edges that are in exactly one parent form the graph GAB, which splits into
+// AB-cycles that alternate between edges of the first and of the second parent. Applying a set of AB-cycles (the
+// E-set) to the first parent swaps those of its edges for the second parent's, which leaves a set of subtours. These
+// are merged by the cheapest 2-opt style reconnection to a candidate neighbor, so the child inherits almost only
+// parental edges.
+
+// How the E-set is picked from the AB-cycles
+enum class EaxStrategy
+{
+	Random, // every AB-cycle with probability 1/2 (EAX-Rand)
+	Single  // one AB-cycle, a local change to the first parent (EAX-1AB)
+};
+
+// Scratch buffers reused across children (keep one per thread)
+struct EaxScratch
+{
+	std::vector<int> mNextA;
+	std::vector<int> mPrevA;
+	std::vector<int> mNextB;
+	std::vector<int> mPrevB;
+	std::vector<int> mEdgesA;
+	std::vector<int> mEdgesB;
+	std::vector<int> mCountA;
+	std::vector<int> mCountB;
+	std::vector<int> mActive;
+	std::vector<int> mPath;
+	std::vector<int> mPathPos;
+	std::vector<int> mCycleVertices;
+	std::vector<int> mCycleStarts;
+	std::vector<char> mCycleFirstIsA;
+	std::vector<int> mESet;
+	std::vector<int> mLinks;
+	std::vector<int> mSubtour;
+	std::vector<int> mSubtourSize;
+	std::vector<int> mSubtourCity;
+	std::vector<int> mMembers;
+	std::vector<std::pair<int,int>> mHeap;
+};
+
+// Builds child from the two parent tours. The distance store must have candidate lists (BuildCandidates). All random
+// choices come from seed, so the same parents and seed always give the same child.
+void EdgeAssemblyCrossover(const std::vector<int>& first, const std::vector<int>& second, const DistanceStore& distances, EaxStrategy strategy, uint64_t seed, EaxScratch& scratch, std::vector<int>& child);
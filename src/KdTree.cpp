@@ -0,0 +1,209 @@
+#include "KdTree.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Function that returns the squared straight-line distance between two points on the unit sphere.
+static double SquaredDistance(const double* a, const double* b) {
+    double dx = a[0] - b[0];
+    double dy = a[1] - b[1];
+    double dz = a[2] - b[2];
+    return dx * dx + dy * dy + dz * dz;
+}
+
+KdTree::KdTree(const std::vector<Location>& locations) {
+    int size = static_cast<int>(locations.size());
+    mPoints.resize(size);
+    for (int i = 0; i < size; i++) {
+        // The same conversion to radians as GetHaversineDistance
+        double latitude = locations[i].mLatitude * 0.0174533;
+        double longitude = locations[i].mLongitude * 0.0174533;
+        mPoints[i].mCoords[0] = cos(latitude) * cos(longitude);
+        mPoints[i].mCoords[1] = cos(latitude) * sin(longitude);
+        mPoints[i].mCoords[2] = sin(latitude);
+        mPoints[i].mCity = i;
+    }
+    mAxes.assign(size, 0);
+    Build(0, size);
+    mPositions.resize(size);
+    for (int i = 0; i < size; i++) {
+        mPositions[mPoints[i].mCity] = i;
+    }
+}
+
+// Function that splits the points of a range at the median of the axis they spread the most along, and recurses.
+void KdTree::Build(int begin, int end) {
+    if (end - begin <= sLeafSize) {
+        return;
+    }
+    double low[3] = { mPoints[begin].mCoords[0], mPoints[begin].mCoords[1], mPoints[begin].mCoords[2] };
+    double high[3] = { low[0], low[1], low[2] };
+    for (int i = begin + 1; i < end; i++) {
+        for (int axis = 0; axis < 3; axis++) {
+            low[axis] = std::min(low[axis], mPoints[i].mCoords[axis]);
+            high[axis] = std::max(high[axis], mPoints[i].mCoords[axis]);
+        }
+    }
+    int axis = 0;
+    for (int other = 1; other < 3; other++) {
+        if (high[other] - low[other] > high[axis] - low[axis]) {
+            axis = other;
+        }
+    }
+
+    int middle = begin + (end - begin) / 2;
+    std::nth_element(mPoints.begin() + begin, mPoints.begin() + middle, mPoints.begin() + end, [axis](const Point& a, const Point& b) {
+        return a.mCoords[axis] < b.mCoords[axis];
+    });
+    mAxes[middle] = static_cast<unsigned char>(axis);
+    Build(begin, middle);
+    Build(middle + 1, end);
+}
+
+// Function that keeps a point among the best ones found so far, sorted nearest first, if it is near enough.
+void KdTree::Offer(const Point& point, Search& search) const {
+    if (point.mCity == search.mQuery->mCity) {
+        return;
+    }
+    if (search.mMarks && search.mMarks->mRemoved[&point - mPoints.data()]) {
+        return;
+    }
+    double distance = SquaredDistance(point.mCoords, search.mQuery->mCoords);
+    if (distance >= search.mBound) {
+        return;
+    }
+    std::vector<std::pair<double,int>>& best = *search.mBest;
+    if (static_cast<int>(best.size()) == search.mCount) {
+        best.pop_back();
+    }
+    auto place = std::upper_bound(best.begin(), best.end(), std::make_pair(distance, point.mCity));
+    best.insert(place, std::make_pair(distance, point.mCity));
+    if (static_cast<int>(best.size()) == search.mCount) {
+        search.mBound = best.back().first;
+    }
+}
+
+void KdTree::SearchNearest(int begin, int end, Search& search) const {
+    if (begin >= end) {
+        return;
+    }
+    int middle = begin + (end - begin) / 2;
+    if (search.mMarks && search.mMarks->mRemaining[middle] == 0) {
+        return;
+    }
+    if (end - begin <= sLeafSize) {
+        for (int i = begin; i < end; i++) {
+            Offer(mPoints[i], search);
+        }
+        return;
+    }
+    int axis = mAxes[middle];
+    double offset = search.mQuery->mCoords[axis] - mPoints[middle].mCoords[axis];
+    // The side of the split the query lies on first, then the other side if it can still hold something nearer.
+    if (offset < 0) {
+        SearchNearest(begin, middle, search);
+    }
+    else {
+        SearchNearest(middle + 1, end, search);
+    }
+    Offer(mPoints[middle], search);
+    if (offset * offset < search.mBound) {
+        if (offset < 0) {
+            SearchNearest(middle + 1, end, search);
+        }
+        else {
+            SearchNearest(begin, middle, search);
+        }
+    }
+}
+
+void KdTree::Nearest(int city, int k, std::vector<std::pair<double,int>>& result) const {
+    result.clear();
+    if (k <= 0) {
+        return;
+    }
+    result.reserve(k);
+    Search search = { &mPoints[mPositions[city]], std::numeric_limits<double>::infinity(), nullptr, &result, k };
+    SearchNearest(0, static_cast<int>(mPoints.size()), search);
+}
+
+void KdTree::SearchRadius(int begin, int end, const Point& query, double bound, std::vector<int>& result) const {
+    if (end - begin <= sLeafSize) {
+        for (int i = begin; i < end; i++) {
+            if (mPoints[i].mCity != query.mCity && SquaredDistance(mPoints[i].mCoords, query.mCoords) <= bound) {
+                result.push_back(mPoints[i].mCity);
+            }
+        }
+        return;
+    }
+    int middle = begin + (end - begin) / 2;
+    double offset = query.mCoords[mAxes[middle]] - mPoints[middle].mCoords[mAxes[middle]];
+    if (mPoints[middle].mCity != query.mCity && SquaredDistance(mPoints[middle].mCoords, query.mCoords) <= bound) {
+        result.push_back(mPoints[middle].mCity);
+    }
+    if (offset <= 0 || offset * offset <= bound) {
+        SearchRadius(begin, middle, query, bound, result);
+    }
+    if (offset >= 0 || offset * offset <= bound) {
+        SearchRadius(middle + 1, end, query, bound, result);
+    }
+}
+
+void KdTree::WithinRadius(int city, double miles, std::vector<int>& result) const {
+    result.clear();
+    // The chord of an arc of the given length on a sphere with the radius GetHaversineDistance uses
+    double angle = std::min(miles / 3961, 3.14159265358979);
+    double chord = 2 * sin(angle / 2);
+    SearchRadius(0, static_cast<int>(mPoints.size()), mPoints[mPositions[city]], chord * chord, result);
+}
+
+// Function that fills in the number of points of every node's subtree, and returns the count of the whole range.
+int KdTree::CountRemaining(int begin, int end, KdTreeMarks& marks) const {
+    if (begin >= end) {
+        return 0;
+    }
+    int middle = begin + (end - begin) / 2;
+    if (end - begin > sLeafSize) {
+        CountRemaining(begin, middle, marks);
+        CountRemaining(middle + 1, end, marks);
+    }
+    marks.mRemaining[middle] = end - begin;
+    return end - begin;
+}
+
+void KdTree::ResetMarks(KdTreeMarks& marks) const {
+    marks.mRemoved.assign(mPoints.size(), 0);
+    marks.mRemaining.assign(mPoints.size(), 0);
+    CountRemaining(0, static_cast<int>(mPoints.size()), marks);
+}
+
+void KdTree::Remove(int city, KdTreeMarks& marks) const {
+    int position = mPositions[city];
+    if (marks.mRemoved[position]) {
+        return;
+    }
+    marks.mRemoved[position] = 1;
+    int begin = 0;
+    int end = static_cast<int>(mPoints.size());
+    while (true) {
+        int middle = begin + (end - begin) / 2;
+        marks.mRemaining[middle]--;
+        if (end - begin <= sLeafSize || position == middle) {
+            return;
+        }
+        if (position < middle) {
+            end = middle;
+        }
+        else {
+            begin = middle + 1;
+        }
+    }
+}
+
+int KdTree::NearestRemaining(int city, const KdTreeMarks& marks) const {
+    std::vector<std::pair<double,int>> best;
+    best.reserve(1);
+    Search search = { &mPoints[mPositions[city]], std::numeric_limits<double>::infinity(), &marks, &best, 1 };
+    SearchNearest(0, static_cast<int>(mPoints.size()), search);
+    return best.empty() ? -1 : best[0].second;
+}
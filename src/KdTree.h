@@ -0,0 +1,72 @@
+#pragma once
+#include <utility>
+#include <vector>
+#include "TSP.h"
+
+// Which points of a KdTree the nearest-remaining query still sees. Keep one set per user (per thread); the tree itself is
+// never modified by queries.
+struct KdTreeMarks
+{
+	std::vector<char> mRemoved; // by position in the tree's array
+	std::vector<int> mRemaining; // points left in the subtree of every node, by the position of the node's middle point
+};
+
+// A static KD-tree over the locations, as points on the unit sphere so that the straight-line (chord) distance orders
+// pairs exactly like the Haversine distance. The tree is implicit: the points are stored in one array where the node
+// for a range of positions keeps its splitting point at the middle position, the points before it on one side of the
+// split and the points after it on the other. Ranges of up to sLeafSize points are scanned. Building takes O(N log N)
+// and a nearest-neighbor query about O(log N) on spread out points.
+class KdTree
+{
+public:
+	static constexpr int sLeafSize = 8;
+
+	KdTree() = default;
+	explicit KdTree(const std::vector<Location>& locations);
+
+	size_t Size() const { return mPoints.size(); }
+
+	// The k nearest other locations of city, nearest first, as (squared chord length, city) pairs. Fewer when there are
+	// not that many other locations.
+	void Nearest(int city, int k, std::vector<std::pair<double,int>>& result) const;
+
+	// Every other location within the given Haversine distance of city, in no particular order.
+	void WithinRadius(int city, double miles, std::vector<int>& result) const;
+
+	// Marks every location as remaining.
+	void ResetMarks(KdTreeMarks& marks) const;
+
+	// Marks a location as removed in O(log N).
+	void Remove(int city, KdTreeMarks& marks) const;
+
+	// The nearest location to city (city itself excluded) that is not removed, or -1 when none is left. Subtrees with
+	// nothing left are skipped, so the query stays fast while the marks fill up.
+	int NearestRemaining(int city, const KdTreeMarks& marks) const;
+
+private:
+	struct Point
+	{
+		double mCoords[3];
+		int mCity;
+	};
+
+	// A query in progress: its point, the best squared distance so far, and the marks it respects (if any)
+	struct Search
+	{
+		const Point* mQuery;
+		double mBound;
+		const KdTreeMarks* mMarks;
+		std::vector<std::pair<double,int>>* mBest;
+		int mCount;
+	};
+
+	void Build(int begin, int end);
+	void SearchNearest(int begin, int end, Search& search) const;
+	void Offer(const Point& point, Search& search) const;
+	void SearchRadius(int begin, int end, const Point& query, double bound, std::vector<int>& result) const;
+	int CountRemaining(int begin, int end, KdTreeMarks& marks) const;
+
+	std::vector<Point> mPoints; // in tree order
+	std::vector<unsigned char> mAxes; // splitting axis of the node whose middle point is at a position
+	std::vector<int> mPositions; // position of every location in mPoints
+};
@@ -0,0 +1,447 @@
+#include "LocalSearch.h"
+#include <algorithm>
+
+namespace
+{
+    // Improvements smaller than this are rounding noise and would let the search cycle.
+    const double sEpsilon = 1e-9;
+
+    // The don't-look bits, kept as a queue of the cities that still need a look (a city is in the queue exactly when its
+    // bit is off). Both tour representations below carry one.
+    class DontLookQueue
+    {
+    public:
+        DontLookQueue(const std::vector<int>& tour, const std::vector<int>* active, LocalSearchScratch& scratch) : mQueued(scratch.mQueued), mQueue(scratch.mQueue), mSize(static_cast<int>(tour.size())) {
+            mQueue.resize(mSize);
+            mHead = 0;
+            if (active) {
+                // Only the active cities start with their don't-look bits off.
+                mQueued.assign(mSize, 0);
+                mCount = 0;
+                for (int city : *active) {
+                    Push(city);
+                }
+                return;
+            }
+            // Every city starts with its don't-look bit off.
+            mQueued.assign(mSize, 1);
+            std::copy(tour.begin(), tour.end(), mQueue.begin());
+            mCount = mSize;
+        }
+
+        bool Empty() const { return mCount == 0; }
+
+        // Takes the next city to look at off the queue (its don't-look bit goes on).
+        int Pop() {
+            int city = mQueue[mHead];
+            mHead = mHead + 1 == mSize ? 0 : mHead + 1;
+            --mCount;
+            mQueued[city] = 0;
+            return city;
+        }
+
+        // Turns the don't-look bit of a city off again.
+        void Push(int city) {
+            if (!mQueued[city]) {
+                mQueued[city] = 1;
+                int tail = mHead + mCount;
+                mQueue[tail >= mSize ? tail - mSize : tail] = city;
+                ++mCount;
+            }
+        }
+
+    private:
+        std::vector<char>& mQueued;
+        std::vector<int>& mQueue;
+        int mSize;
+        int mHead = 0;
+        int mCount = 0;
+    };
+
+    // The tour as an array plus the position of every city in it. Reversals cost O(N).
+    class ArrayTour : public DontLookQueue
+    {
+    public:
+        ArrayTour(std::vector<int>& tour, const std::vector<int>* active, LocalSearchScratch& scratch) : DontLookQueue(tour, active, scratch), mTour(tour), mPositions(scratch.mPositions), mSize(static_cast<int>(tour.size())) {
+            mPositions.resize(mSize);
+            for (int i = 0; i < mSize; i++) {
+                mPositions[mTour[i]] = i;
+            }
+        }
+
+        int Next(int city) const { return mTour[mPositions[city] + 1 == mSize ? 0 : mPositions[city] + 1]; }
+        int Prev(int city) const { return mTour[mPositions[city] == 0 ? mSize - 1 : mPositions[city] - 1]; }
+
+        // Reverses the path from city from to city to (following Next). Reversing either side of a cycle gives the same
+        // cycle, so the shorter side is reversed.
+        void Reverse(int from, int to) {
+            int begin = mPositions[from];
+            int end = mPositions[to];
+            int length = (end - begin + mSize) % mSize + 1;
+            if (2 * length > mSize) {
+                begin = end + 1 == mSize ? 0 : end + 1;
+                end = mPositions[from] == 0 ? mSize - 1 : mPositions[from] - 1;
+                length = mSize - length;
+            }
+            for (int step = 0; step < length / 2; step++) {
+                std::swap(mTour[begin], mTour[end]);
+                mPositions[mTour[begin]] = begin;
+                mPositions[mTour[end]] = end;
+                begin = begin + 1 == mSize ? 0 : begin + 1;
+                end = end == 0 ? mSize - 1 : end - 1;
+            }
+        }
+
+    private:
+        std::vector<int>& mTour;
+        std::vector<int>& mPositions;
+        int mSize;
+    };
+
+    // The tour as a two-level doubly-linked list. Reversals cost O(sqrt(N)).
+    class ListTour : public DontLookQueue
+    {
+    public:
+        ListTour(std::vector<int>& tour, const std::vector<int>* active, LocalSearchScratch& scratch) : DontLookQueue(tour, active, scratch), mList(scratch.mList) {
+            mList.Assign(tour);
+        }
+
+        int Next(int city) const { return mList.Next(city); }
+        int Prev(int city) const { return mList.Prev(city); }
+        void Reverse(int from, int to) { mList.Reverse(from, to); }
+
+    private:
+        TwoLevelTour& mList;
+    };
+}
+
+// Function that looks for an improving 2-opt move at city a. It tries both tour neighbors of a, and for each one only the
+// candidates that are nearer to a than that neighbor, since otherwise the first new edge cannot pay for itself.
+template <typename Tour>
+static bool ImproveTwoOpt(Tour& tour, const DistanceStore& distances, int a) {
+    for (int direction = 0; direction < 2; direction++) {
+        int b = direction == 0 ? tour.Next(a) : tour.Prev(a);
+        double removed = distances.Get(a, b);
+        const int* candidates = distances.Candidates(a);
+        for (int i = 0; i < distances.CandidateCount(); i++) {
+            int c = candidates[i];
+            double added = distances.Get(a, c);
+            if (added >= removed) {
+                break;
+            }
+            int d = direction == 0 ? tour.Next(c) : tour.Prev(c);
+            if (c == b || d == a) {
+                continue;
+            }
+            double delta = added + distances.Get(b, d) - removed - distances.Get(c, d);
+            if (delta < -sEpsilon) {
+                // In tour order, a b ... c d becomes a c ... b d, and b a ... d c becomes b d ... a c.
+                if (direction == 0) {
+                    tour.Reverse(b, c);
+                }
+                else {
+                    tour.Reverse(a, d);
+                }
+                tour.Push(a);
+                tour.Push(b);
+                tour.Push(c);
+                tour.Push(d);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Function that moves the segment s1..s2 (in tour order) between the adjacent cities x and y (y follows x), so that x is
+// followed by first and the other end of the segment is followed by y. The tour p s1..s2 n ... x y is turned into
+// p n ... x s2..s1 y by two reversals, and a third short one puts s1 first if first is s1.
+template <typename Tour>
+static void MoveSegment(Tour& tour, int s1, int s2, int x, int first) {
+    int p = tour.Prev(s1);
+    int n = tour.Next(s2);
+    // p s1..s2 n ... x y becomes p x ... n s2..s1 y.
+    tour.Reverse(s1, x);
+    // Reverse may have flipped the other side instead, so follow the tour from whichever end now comes first.
+    if (tour.Next(p) == x) {
+        tour.Reverse(x, n);
+    }
+    else {
+        tour.Reverse(n, x);
+    }
+    // Now x s2..s1 y, read in one direction or the other.
+    if (first == s1) {
+        if (tour.Next(x) == s2) {
+            tour.Reverse(s2, s1);
+        }
+        else {
+            tour.Reverse(s1, s2);
+        }
+    }
+}
+
+// Function that tries to move a segment of 1 to 3 cities that starts or ends at city a next to one of the candidate
+// neighbors of its ends. Every move is priced in O(1): the gain of closing the gap p n against the cost of opening the edge
+// x y, in either orientation of the segment.
+template <typename Tour>
+static bool ImproveOrOpt(Tour& tour, const DistanceStore& distances, int a, int size) {
+    for (int length = 1; length <= 3 && length + 3 <= size; length++) {
+        for (int direction = 0; direction < (length == 1 ? 1 : 2); direction++) {
+            // The segment s1..s2 in tour order, with a at its start (direction 0) or its end (direction 1).
+            int s1 = a;
+            int s2 = a;
+            for (int k = 1; k < length; k++) {
+                if (direction == 0) {
+                    s2 = tour.Next(s2);
+                }
+                else {
+                    s1 = tour.Prev(s1);
+                }
+            }
+            int p = tour.Prev(s1);
+            int n = tour.Next(s2);
+            double removeGain = distances.Get(p, s1) + distances.Get(s2, n) - distances.Get(p, n);
+            if (removeGain <= sEpsilon) {
+                continue;
+            }
+
+            // Look for an edge x y near either end of the segment. end is the segment end that becomes adjacent to the
+            // candidate, other is the opposite end.
+            for (int side = 0; side < 2; side++) {
+                int end = side == 0 ? s1 : s2;
+                int other = side == 0 ? s2 : s1;
+                const int* candidates = distances.Candidates(end);
+                for (int i = 0; i < distances.CandidateCount(); i++) {
+                    int c = candidates[i];
+                    double added = distances.Get(end, c);
+                    if (added >= removeGain) {
+                        break;
+                    }
+                    // c must be outside the segment, which holds at most three cities.
+                    if (c == s1 || c == s2 || (length == 3 && c == tour.Next(s1))) {
+                        continue;
+                    }
+
+                    // Insert between c and its successor (c end ... other next) or its predecessor (prev other ... end c).
+                    for (int edge = 0; edge < 2; edge++) {
+                        int x = edge == 0 ? c : tour.Prev(c);
+                        int y = edge == 0 ? tour.Next(c) : c;
+                        if (x == s2 || y == s1) {
+                            continue;
+                        }
+                        int far = edge == 0 ? y : x;
+                        double delta = added + distances.Get(other, far) - distances.Get(x, y) - removeGain;
+                        if (delta < -sEpsilon) {
+                            MoveSegment(tour, s1, s2, x, edge == 0 ? end : other);
+                            tour.Push(p);
+                            tour.Push(n);
+                            tour.Push(s1);
+                            tour.Push(s2);
+                            tour.Push(x);
+                            tour.Push(y);
+                            return true;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+// Function that makes the Lin-Kernighan flip for the tour edge (t1, t2): the path from t2 to t4 (going away from t1) is
+// reversed, so t1 is followed by t4 and t2 by the city that followed t4. Flipping (t1, t4, t2) undoes it.
+template <typename Tour>
+static void Flip(Tour& tour, int t1, int t2, int t4) {
+    if (tour.Next(t1) == t2) {
+        tour.Reverse(t2, t4);
+    }
+    else {
+        tour.Reverse(t4, t2);
+    }
+}
+
+// The state of one Lin-Kernighan chain started at t1
+template <typename Tour>
+struct LinKernighanChain {
+    Tour& mTour;
+    const DistanceStore& mDistances;
+    std::vector<std::pair<int,int>>& mFlips; // (t2, t4) of every flip made, in order
+    std::vector<std::pair<double,int>>& mAlternatives; // the ranked choices of t3 of every level of the chain
+    int mT1;
+    double mBestGain = 0.0;
+    size_t mBestDepth = 0; // number of flips that gives the best gain (0 while there is none)
+};
+
+// Function that extends the chain from the last removed edge (t1, t2), where gain is the length removed so far minus the
+// length added. The choices of t3 that keep the partial gain positive are ranked by the length of the edge (t3, t4) they
+// remove minus the edge (t2, t3) they add (the lookahead rule), and the best sBreadth[level] of them are tried (only the
+// best one below the first levels). Returns true once an improving prefix was found, leaving the flips applied; otherwise
+// undoes its flips.
+template <typename Tour>
+static bool ExtendChain(LinKernighanChain<Tour>& chain, int level, double gain, int t2) {
+    static const int sBreadth[] = { 5, 3, 1 };
+    const int maxDepth = 50;
+    Tour& tour = chain.mTour;
+    const DistanceStore& distances = chain.mDistances;
+    bool forward = tour.Next(chain.mT1) == t2;
+    int t2After = forward ? tour.Next(t2) : tour.Prev(t2);
+    int breadth = level < 3 ? sBreadth[level] : 1;
+
+    // Collect the choices on the shared stack, above those of the levels below.
+    std::vector<std::pair<double,int>>& alternatives = chain.mAlternatives;
+    size_t first = alternatives.size();
+    const int* candidates = distances.Candidates(t2);
+    for (int i = 0; i < distances.CandidateCount(); i++) {
+        int t3 = candidates[i];
+        double added = distances.Get(t2, t3);
+        if (gain - added <= sEpsilon) {
+            break;
+        }
+        if (t3 == t2After || t3 == chain.mT1) {
+            continue;
+        }
+        int t4 = forward ? tour.Prev(t3) : tour.Next(t3);
+        alternatives.emplace_back(distances.Get(t3, t4) - added, t3);
+    }
+    size_t count = std::min(alternatives.size() - first, static_cast<size_t>(breadth));
+    std::partial_sort(alternatives.begin() + first, alternatives.begin() + first + count, alternatives.end(), [](const std::pair<double,int>& a, const std::pair<double,int>& b) {
+        return a.first > b.first;
+    });
+
+    for (size_t k = 0; k < count; k++) {
+        // Flips deeper in the chain were undone, so t3's neighbors are as they were when the choices were collected. The
+        // undo may have reversed the other side of the cycle, though, which swaps Next and Prev, so the direction is
+        // taken again.
+        forward = tour.Next(chain.mT1) == t2;
+        int t3 = alternatives[first + k].second;
+        int t4 = forward ? tour.Prev(t3) : tour.Next(t3);
+        double next = gain + alternatives[first + k].first;
+
+        Flip(tour, chain.mT1, t2, t4);
+        chain.mFlips.emplace_back(t2, t4);
+        double closed = next - distances.Get(t4, chain.mT1);
+        if (closed > chain.mBestGain + sEpsilon) {
+            chain.mBestGain = closed;
+            chain.mBestDepth = chain.mFlips.size();
+        }
+        if (level + 1 < maxDepth) {
+            ExtendChain(chain, level + 1, next, t4);
+        }
+        // Once the chain improves the tour there is no more backtracking; the caller trims it to the best prefix.
+        if (chain.mBestDepth > 0) {
+            alternatives.resize(first);
+            return true;
+        }
+        chain.mFlips.pop_back();
+        Flip(tour, chain.mT1, t4, t2);
+    }
+    alternatives.resize(first);
+    return false;
+}
+
+// Function that looks for an improving Lin-Kernighan chain from both tour edges of city t1, keeping only the flips up to
+// the best gain.
+template <typename Tour>
+static bool ImproveLinKernighan(Tour& tour, const DistanceStore& distances, int t1, LocalSearchScratch& scratch) {
+    std::vector<std::pair<int,int>>& flips = scratch.mFlips;
+    for (int direction = 0; direction < 2; direction++) {
+        int t2 = direction == 0 ? tour.Next(t1) : tour.Prev(t1);
+        flips.clear();
+        scratch.mAlternatives.clear();
+        LinKernighanChain<Tour> chain{ tour, distances, flips, scratch.mAlternatives, t1 };
+        if (ExtendChain(chain, 0, distances.Get(t1, t2), t2)) {
+            while (flips.size() > chain.mBestDepth) {
+                Flip(tour, t1, flips.back().second, flips.back().first);
+                flips.pop_back();
+            }
+            tour.Push(t1);
+            for (const auto& flip : flips) {
+                tour.Push(flip.first);
+                tour.Push(flip.second);
+                tour.Push(tour.Next(flip.first));
+                tour.Push(tour.Prev(flip.first));
+                tour.Push(tour.Next(flip.second));
+                tour.Push(tour.Prev(flip.second));
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+// Function that takes cities off the don't-look queue and lets improve look for a move at each one, until the queue is
+// empty or maxMoves improving moves were made.
+template <typename Tour, typename Improve>
+static int RunQueue(Tour& searchTour, int maxMoves, Improve& improve) {
+    int moves = 0;
+    while (!searchTour.Empty() && (maxMoves <= 0 || moves < maxMoves)) {
+        // An improving move puts the city back on the queue, since its new neighbors may allow another move.
+        if (improve(searchTour, searchTour.Pop())) {
+            ++moves;
+        }
+    }
+    return moves;
+}
+
+// Function that runs a local search on the array tour, or on the two-level list once the tour has
+// scratch.mTwoLevelFrom cities, and leaves the tour starting at location 0 again. Every city starts on the don't-look
+// queue, or only the active ones if they are given.
+template <typename Improve>
+static int RunLocalSearch(std::vector<int>& tour, const DistanceStore& distances, int maxMoves, const std::vector<int>* active, LocalSearchScratch& scratch, Improve improve) {
+    if (tour.size() < 4 || distances.CandidateCount() == 0) {
+        return 0;
+    }
+
+    if (tour.size() >= scratch.mTwoLevelFrom) {
+        ListTour listTour(tour, active, scratch);
+        int moves = RunQueue(listTour, maxMoves, improve);
+        scratch.mList.ToVector(tour);
+        return moves;
+    }
+
+    ArrayTour arrayTour(tour, active, scratch);
+    int moves = RunQueue(arrayTour, maxMoves, improve);
+    // Reversals may have moved location 0, so rotate the tour to start there again.
+    std::rotate(tour.begin(), std::find(tour.begin(), tour.end(), 0), tour.end());
+    return moves;
+}
+
+int TwoOpt(std::vector<int>& tour, const DistanceStore& distances, int maxMoves, LocalSearchScratch& scratch) {
+    return RunLocalSearch(tour, distances, maxMoves, nullptr, scratch, [&distances](auto& searchTour, int city) {
+        return ImproveTwoOpt(searchTour, distances, city);
+    });
+}
+
+int OrOpt(std::vector<int>& tour, const DistanceStore& distances, int maxMoves, LocalSearchScratch& scratch) {
+    int size = static_cast<int>(tour.size());
+    return RunLocalSearch(tour, distances, maxMoves, nullptr, scratch, [&distances, size](auto& searchTour, int city) {
+        return ImproveOrOpt(searchTour, distances, city, size);
+    });
+}
+
+int TwoOptOrOpt(std::vector<int>& tour, const DistanceStore& distances, int maxMoves, LocalSearchScratch& scratch) {
+    int size = static_cast<int>(tour.size());
+    return RunLocalSearch(tour, distances, maxMoves, nullptr, scratch, [&distances, size](auto& searchTour, int city) {
+        return ImproveTwoOpt(searchTour, distances, city) || ImproveOrOpt(searchTour, distances, city, size);
+    });
+}
+
+// Function that runs the Lin-Kernighan search with every city on the don't-look queue, or only the active ones.
+static int RunLinKernighan(std::vector<int>& tour, const DistanceStore& distances, int maxMoves, const std::vector<int>* active, LocalSearchScratch& scratch) {
+    if (tour.size() < 5) {
+        return 0;
+    }
+    int size = static_cast<int>(tour.size());
+    return RunLocalSearch(tour, distances, maxMoves, active, scratch, [&distances, &scratch, size](auto& searchTour, int city) {
+        return ImproveLinKernighan(searchTour, distances, city, scratch) || ImproveOrOpt(searchTour, distances, city, size);
+    });
+}
+
+int LinKernighan(std::vector<int>& tour, const DistanceStore& distances, int maxMoves, LocalSearchScratch& scratch) {
+    return RunLinKernighan(tour, distances, maxMoves, nullptr, scratch);
+}
+
+int LinKernighan(std::vector<int>& tour, const DistanceStore& distances, const std::vector<int>& active, int maxMoves, LocalSearchScratch& scratch) {
+    return RunLinKernighan(tour, distances, maxMoves, &active, scratch);
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <utility>
+#include <vector>
+#include "Distance.h"
+#include "TwoLevelTour.h"
+
+// Local search that improves a single tour in place. The moves only look at the candidate neighbors of each city (the
+// distance store must have candidate lists) and keep a don't-look bit per city: a city is only looked at again after
+// one of its tour edges changed. Each pass is therefore close to linear in the number of cities.
+
+// Scratch buffers reused across tours (keep one per thread)
+struct LocalSearchScratch
+{
+	std::vector<int> mPositions;
+	std::vector<char> mQueued;
+	std::vector<int> mQueue;
+	std::vector<std::pair<int,int>> mFlips;
+	std::vector<std::pair<double,int>> mAlternatives;
+	TwoLevelTour mList;
+	// Tours with at least this many cities are searched on the two-level list, whose reversals cost O(sqrt(N)) instead of
+	// O(N); shorter ones on the array, which is faster to walk.
+	size_t mTwoLevelFrom = 1000;
+};
+
+// 2-opt: replaces two tour edges (a, b) and (c, d) by (a, c) and (b, d) whenever that shortens the tour, reversing the
+// shorter side of the tour in between. Stops at a 2-opt local optimum, or after maxMoves improving moves when maxMoves
+// is positive. The tour still starts at location 0 afterwards. Returns the number of improving moves made.
+int TwoOpt(std::vector<int>& tour, const DistanceStore& distances, int maxMoves, LocalSearchScratch& scratch);
+
+// Or-opt: moves a segment of 1 to 3 consecutive cities, in either orientation, between two adjacent cities next to a
+// candidate neighbor of one of its ends, whenever that shortens the tour. Each move is priced in O(1) and applied in
+// place by reversals, without allocating once the scratch buffers have grown to the tour size. Same stopping rule and
+// return value as TwoOpt.
+int OrOpt(std::vector<int>& tour, const DistanceStore& distances, int maxMoves, LocalSearchScratch& scratch);
+
+// 2-opt and Or-opt together: every city looked at tries a 2-opt move first and an Or-opt move second, sharing the
+// don't-look bits, until neither finds an improvement.
+int TwoOptOrOpt(std::vector<int>& tour, const DistanceStore& distances, int maxMoves, LocalSearchScratch& scratch);
+
+// Lin-Kernighan style variable-depth search: starting from a tour edge (t1, t2), it adds an edge from t2 to a candidate
+// neighbor t3 and removes the edge (t3, t4) that lets the tour close with (t4, t1), which is one 2-opt flip, and then goes
+// on from t4. The chain can grow to 50 flips. It backtracks over several choices of t3 at the first levels, and keeps
+// the prefix of flips with the best total gain. Cities where no chain improves the tour also try Or-opt moves, so the
+// engine covers the segment insertions (or-3opt moves) that a chain of flips misses. Same stopping rule and return value
+// as TwoOpt.
+int LinKernighan(std::vector<int>& tour, const DistanceStore& distances, int maxMoves, LocalSearchScratch& scratch);
+
+// Lin-Kernighan that starts with only the active cities off their don't-look bits, for a tour that is already a local
+// optimum everywhere else (like tours joined at a few seams). The search still spreads to the cities whose tour edges
+// its moves change, so beyond the O(N) setup of the tour its work grows with the active cities, not with the tour.
+int LinKernighan(std::vector<int>& tour, const DistanceStore& distances, const std::vector<int>& active, int maxMoves, LocalSearchScratch& scratch);
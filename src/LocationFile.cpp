@@ -0,0 +1,133 @@
+#include "LocationFile.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(std::string_view path) {
+    std::string name(path);
+#if !defined(_WIN32)
+    int descriptor = open(name.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        return;
+    }
+    mOpen = true;
+    struct stat status {};
+    if (fstat(descriptor, &status) == 0 && status.st_size > 0) {
+        void* data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (data != MAP_FAILED) {
+            // The lines are read once, front to back.
+            madvise(data, static_cast<size_t>(status.st_size), MADV_SEQUENTIAL);
+            mData = static_cast<const char*>(data);
+            mSize = static_cast<size_t>(status.st_size);
+            mMapped = true;
+        }
+    }
+    close(descriptor);
+    if (mMapped || status.st_size == 0) {
+        return;
+    }
+#endif
+    // No mapping: read a copy of the file instead.
+    std::ifstream in(name, std::ios::binary);
+    if (!in.is_open()) {
+        return;
+    }
+    mOpen = true;
+    mCopy.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    mData = mCopy.data();
+    mSize = mCopy.size();
+}
+
+MappedFile::~MappedFile() {
+#if !defined(_WIN32)
+    if (mMapped) {
+        munmap(const_cast<char*>(mData), mSize);
+    }
+#endif
+}
+
+// Function that parses the number at the start of [begin, end), after any blanks or plus sign, and throws with the line
+// number when there is none.
+static double ParseCoordinate(const char* begin, const char* end, size_t line) {
+    while (begin < end && (*begin == ' ' || *begin == '\t' || *begin == '+')) {
+        begin++;
+    }
+    double value = 0.0;
+    std::from_chars_result result = std::from_chars(begin, end, value);
+    if (result.ec != std::errc()) {
+        throw std::invalid_argument("Invalid coordinate on line " + std::to_string(line));
+    }
+    return value;
+}
+
+void ParseLocations(std::string_view text, std::vector<LocationRecord>& records) {
+    const char* position = text.data();
+    const char* end = text.data() + text.size();
+    size_t line = 0;
+    // A line of a name and two coordinates takes about 24 bytes or more, which is close enough to reserve the records
+    // without a separate pass over the text to count its lines.
+    records.reserve(records.size() + text.size() / 24 + 1);
+    while (position < end) {
+        line++;
+        const char* newline = static_cast<const char*>(std::memchr(position, '\n', end - position));
+        const char* lineEnd = newline ? newline : end;
+        if (lineEnd > position && lineEnd[-1] == '\r') {
+            lineEnd--;
+        }
+
+        if (lineEnd > position) {
+            // name,latitude,longitude with the longitude ending at the next comma or the end of the line
+            const char* firstComma = static_cast<const char*>(std::memchr(position, ',', lineEnd - position));
+            const char* secondComma = firstComma ? static_cast<const char*>(std::memchr(firstComma + 1, ',', lineEnd - firstComma - 1)) : nullptr;
+            if (!secondComma) {
+                throw std::invalid_argument("Missing field on line " + std::to_string(line));
+            }
+            const char* thirdComma = static_cast<const char*>(std::memchr(secondComma + 1, ',', lineEnd - secondComma - 1));
+
+            LocationRecord record;
+            record.mName = std::string_view(position, firstComma - position);
+            record.mLatitude = ParseCoordinate(firstComma + 1, secondComma, line);
+            record.mLongitude = ParseCoordinate(secondComma + 1, thirdComma ? thirdComma : lineEnd, line);
+            records.push_back(record);
+        }
+        position = newline ? newline + 1 : end;
+    }
+}
+
+void ParallelParseLocations(std::string_view text, ThreadPool& pool, std::vector<std::vector<LocationRecord>>& chunks) {
+    const size_t minimumParallelSize = 1 << 20;
+    size_t count = text.size() < minimumParallelSize ? 1 : static_cast<size_t>(pool.GetThreadCount());
+
+    // Every chunk but the first starts after the first newline at or past its share of the text.
+    std::vector<size_t> starts(count + 1, text.size());
+    starts[0] = 0;
+    for (size_t i = 1; i < count; i++) {
+        size_t from = std::max(text.size() * i / count, starts[i - 1]);
+        const void* newline = from == 0 ? nullptr : std::memchr(text.data() + from - 1, '\n', text.size() - from + 1);
+        starts[i] = newline ? static_cast<const char*>(newline) - text.data() + 1 : text.size();
+    }
+
+    chunks.assign(count, std::vector<LocationRecord>());
+    try {
+        pool.ParallelFor(count, [&](size_t begin, size_t end, int) {
+            for (size_t i = begin; i < end; i++) {
+                ParseLocations(text.substr(starts[i], starts[i + 1] - starts[i]), chunks[i]);
+            }
+        });
+    }
+    catch (const std::invalid_argument&) {
+        // A chunk only knows its own line numbers.
+        std::vector<LocationRecord> records;
+        ParseLocations(text, records);
+        throw;
+    }
+}
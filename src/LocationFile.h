@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Parallel.h"
+
+// Fast reading of the "name,latitude,longitude" input files. The file is memory mapped instead of copied through a
+// stream, the lines are found with memchr and the coordinates parsed with std::from_chars, so parsing makes no
+// allocation per line: the names are views into the mapping, which must outlive them.
+
+// A location as it appears in the input file
+struct LocationRecord
+{
+	std::string_view mName;
+	double mLatitude = 0.0;
+	double mLongitude = 0.0;
+};
+
+// A read-only memory mapping of a whole file (a plain copy where mmap is not available). A file that cannot be opened
+// maps to empty text.
+class MappedFile
+{
+public:
+	explicit MappedFile(std::string_view path);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool IsOpen() const { return mOpen; }
+	std::string_view Text() const { return std::string_view(mData, mSize); }
+
+private:
+	const char* mData = nullptr;
+	size_t mSize = 0;
+	bool mOpen = false;
+	bool mMapped = false;
+	std::string mCopy;
+};
+
+// Function that parses "name,latitude,longitude" lines and appends them to records. Lines may end in "\n" or "\r\n",
+// blank lines (such as a trailing newline) are skipped, and anything after the longitude is ignored. Throws
+// std::invalid_argument naming the line when a line lacks a field or a coordinate is not a number.
+void ParseLocations(std::string_view text, std::vector<LocationRecord>& records);
+
+// Function that parses the text on the thread pool: it is cut into one chunk per thread at line boundaries, and chunks[i]
+// gets the records of chunk i, so the chunks in order hold the same records as ParseLocations. Texts under a megabyte
+// are parsed as a single chunk. On a bad line the text is parsed again serially, to throw the same error as ParseLocations.
+void ParallelParseLocations(std::string_view text, ThreadPool& pool, std::vector<std::vector<LocationRecord>>& chunks);
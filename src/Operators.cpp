@@ -0,0 +1,156 @@
+#include "Operators.h"
+#include <algorithm>
+#include <iterator>
+
+// Function that builds a child from the prefix of one parent and the rest of the other parent.
+void SpliceCrossover(const std::vector<int>& first, const std::vector<int>& second, int cut, CrossoverScratch& scratch, std::vector<int>& child) {
+    child.clear();
+    child.reserve(first.size());
+
+    // Copy the first part of the genome from the first parent, marking each copied gene as visited.
+    scratch.mVisited.Clear(first.size());
+    std::copy_n(first.begin(), cut + 1, std::back_inserter(child));
+    for (int gene : child) {
+        scratch.mVisited.Insert(gene);
+    }
+
+    // Copy the remaining part of the genome from the second parent, skipping any genes already present.
+    std::copy_if(second.begin(), second.end(), std::back_inserter(child), [&scratch](const int& i) {
+        return !scratch.mVisited.Contains(i);
+    });
+}
+
+// Function that builds a child with order crossover (OX1). Tours are cycles, so the fill wraps around through position 0
+// like any other position, and the child is rotated at the end so that location 0 is first again. Reading the second parent
+// starts right after the city that ends the segment (not at the same position), so parents that are the same cycle give
+// that cycle back.
+void OrderCrossover(const std::vector<int>& first, const std::vector<int>& second, int begin, int end, CrossoverScratch& scratch, std::vector<int>& child) {
+    int size = static_cast<int>(first.size());
+    scratch.mBuffer.resize(size);
+
+    // Keep the segment of the first parent in place.
+    scratch.mVisited.Clear(size);
+    for (int k = begin; k <= end; k++) {
+        scratch.mBuffer[k] = first[k];
+        scratch.mVisited.Insert(first[k]);
+    }
+
+    // Walk the second parent from just after the last city of the segment and the child from just after the segment,
+    // wrapping around, and fill the free positions with the cities that are not used yet.
+    int read = static_cast<int>(std::find(second.begin(), second.end(), first[end]) - second.begin());
+    int write = end;
+    for (int step = 1; step < size; step++) {
+        int gene = second[(read + step) % size];
+        if (!scratch.mVisited.Contains(gene)) {
+            write = (write + 1) % size;
+            scratch.mBuffer[write] = gene;
+        }
+    }
+
+    // Rotate the cycle so that it starts at location 0 again.
+    child.resize(size);
+    auto zero = std::find(scratch.mBuffer.begin(), scratch.mBuffer.end(), 0);
+    std::rotate_copy(scratch.mBuffer.begin(), zero, scratch.mBuffer.end(), child.begin());
+}
+
+// Function that builds a child with partially mapped crossover (PMX) on positions 1..n-1.
+void PartiallyMappedCrossover(const std::vector<int>& first, const std::vector<int>& second, int begin, int end, CrossoverScratch& scratch, std::vector<int>& child) {
+    int size = static_cast<int>(first.size());
+    child.assign(second.begin(), second.end());
+
+    // Where each city sits in the first parent, to follow the mapping of the segment.
+    scratch.mPositions.resize(size);
+    for (int k = 0; k < size; k++) {
+        scratch.mPositions[first[k]] = k;
+    }
+
+    // Keep the segment of the first parent in place.
+    scratch.mVisited.Clear(size);
+    for (int k = begin; k <= end; k++) {
+        child[k] = first[k];
+        scratch.mVisited.Insert(first[k]);
+    }
+
+    // Outside the segment take the second parent's city. If the segment already used it, follow the mapping
+    // first[p] -> second[p] until reaching a city that the segment does not use.
+    for (int k = 1; k < size; k++) {
+        if (k >= begin && k <= end) {
+            continue;
+        }
+        int gene = second[k];
+        while (scratch.mVisited.Contains(gene)) {
+            gene = second[scratch.mPositions[gene]];
+        }
+        child[k] = gene;
+    }
+}
+
+// Function that builds a child with greedy crossover. The successor tables of both parents are built once, so each step
+// looks at two edges, and the visited set skips the cities that are already in the child.
+void GreedyCrossover(const std::vector<int>& first, const std::vector<int>& second, const DistanceStore& distances, CrossoverScratch& scratch, std::vector<int>& child) {
+    int size = static_cast<int>(first.size());
+    std::vector<int>& nextInFirst = scratch.mPositions;
+    std::vector<int>& nextInSecond = scratch.mBuffer;
+    nextInFirst.resize(size);
+    nextInSecond.resize(size);
+    for (int k = 0; k < size; k++) {
+        nextInFirst[first[k]] = first[(k + 1) % size];
+        nextInSecond[second[k]] = second[(k + 1) % size];
+    }
+
+    child.resize(size);
+    child[0] = 0;
+    scratch.mVisited.Clear(size);
+    scratch.mVisited.Insert(0);
+    int sweep = 1; // every city before this position of first is already in the child
+    for (int k = 1; k < size; k++) {
+        int current = child[k - 1];
+        int fromFirst = nextInFirst[current];
+        int fromSecond = nextInSecond[current];
+        bool firstFree = !scratch.mVisited.Contains(fromFirst);
+        bool secondFree = !scratch.mVisited.Contains(fromSecond);
+
+        int next = -1;
+        if (firstFree && secondFree) {
+            next = distances.Get(current, fromSecond) < distances.Get(current, fromFirst) ? fromSecond : fromFirst;
+        }
+        else if (firstFree) {
+            next = fromFirst;
+        }
+        else if (secondFree) {
+            next = fromSecond;
+        }
+        else {
+            // Both parental edges lead back into the child, so take the nearest unused candidate neighbor instead.
+            const int* candidates = distances.Candidates(current);
+            for (int i = 0; i < distances.CandidateCount() && next < 0; i++) {
+                if (!scratch.mVisited.Contains(candidates[i])) {
+                    next = candidates[i];
+                }
+            }
+            if (next < 0) {
+                while (scratch.mVisited.Contains(first[sweep])) {
+                    sweep++;
+                }
+                next = first[sweep];
+            }
+        }
+
+        child[k] = next;
+        scratch.mVisited.Insert(next);
+    }
+}
+
+// Function that reverses the segment tour[begin..end] in place.
+void InversionMutation(std::vector<int>& tour, int begin, int end) {
+    std::reverse(tour.begin() + begin, tour.begin() + end + 1);
+}
+
+// Function that prices an inversion: a tour[begin..end] b becomes a tour[end..begin] b, so only (a, tour[begin]) and
+// (tour[end], b) are replaced by (a, tour[end]) and (tour[begin], b).
+double InversionDelta(const std::vector<int>& tour, int begin, int end, const DistanceStore& distances) {
+    int size = static_cast<int>(tour.size());
+    int before = tour[begin - 1];
+    int after = tour[end + 1 == size ? 0 : end + 1];
+    return distances.Get(before, tour[end]) + distances.Get(tour[begin], after) - distances.Get(before, tour[begin]) - distances.Get(tour[end], after);
+}
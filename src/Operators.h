@@ -0,0 +1,42 @@
+#pragma once
+#include <vector>
+#include "VisitedSet.h"
+#include "EAX.h"
+
+// Permutation crossover operators. Each one fills child from two parent tours given the cut points that were drawn
+// for it, in O(n) using only the scratch space passed in. Position 0 (location 0) is never moved, so cut points are
+// in 1..n-1 and every child starts at location 0 like its parents.
+
+// Scratch buffers reused across children (keep one per thread)
+struct CrossoverScratch
+{
+	VisitedSet mVisited;
+	std::vector<int> mPositions;
+	std::vector<int> mBuffer;
+	EaxScratch mEax;
+};
+
+// The original operator: first[0..cut] followed by the remaining cities in the order they appear in second.
+void SpliceCrossover(const std::vector<int>& first, const std::vector<int>& second, int cut, CrossoverScratch& scratch, std::vector<int>& child);
+
+// Order crossover (OX1): first[begin..end] stays in place and the other positions are filled, starting after end and
+// wrapping around, with the remaining cities in the order they appear in second after first[end]. The child is rotated
+// so that location 0 is first.
+void OrderCrossover(const std::vector<int>& first, const std::vector<int>& second, int begin, int end, CrossoverScratch& scratch, std::vector<int>& child);
+
+// Partially mapped crossover (PMX): first[begin..end] stays in place and every other position takes second's city,
+// following the mapping of the copied segment when that city is already used.
+void PartiallyMappedCrossover(const std::vector<int>& first, const std::vector<int>& second, int begin, int end, CrossoverScratch& scratch, std::vector<int>& child);
+
+// Greedy crossover: starting at location 0, the child repeatedly moves to the nearer of the current city's successors
+// in the two parents. When both are already used it takes the nearest unused candidate neighbor, or else the next
+// unused city in first's order. Edge lengths come from the distance store; candidate lists are optional.
+void GreedyCrossover(const std::vector<int>& first, const std::vector<int>& second, const DistanceStore& distances, CrossoverScratch& scratch, std::vector<int>& child);
+
+// Inversion mutation: reverses tour[begin..end] (1 <= begin <= end < n), which only replaces the edge into the segment and
+// the edge out of it.
+void InversionMutation(std::vector<int>& tour, int begin, int end);
+
+// The change in tour length that InversionMutation(tour, begin, end) makes, priced in O(1) from the two replaced edges
+// before the segment is reversed. Adding it to a known tour length gives the mutated tour's length without a full pass.
+double InversionDelta(const std::vector<int>& tour, int begin, int end, const DistanceStore& distances);
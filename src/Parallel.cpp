@@ -0,0 +1,90 @@
+#include "Parallel.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(int threadCount) {
+    // Default to one thread per core, but always have at least the calling thread.
+    if (threadCount <= 0) {
+        threadCount = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    mThreadCount = std::max(threadCount, 1);
+
+    // Block 0 is run by the calling thread, every other block has its own worker.
+    for (int block = 1; block < mThreadCount; block++) {
+        mWorkers.emplace_back(&ThreadPool::WorkerLoop, this, block);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mJobReady.notify_all();
+    for (auto& worker : mWorkers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t, size_t, int)>& body) {
+    // Nothing to share with the workers, so skip the synchronization.
+    if (mWorkers.empty()) {
+        body(0, count, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mBody = &body;
+        mCount = count;
+        mPending = mThreadCount - 1;
+        mError = nullptr;
+        ++mJobId;
+    }
+    mJobReady.notify_all();
+
+    RunBlock(0);
+
+    // Wait for the workers to finish their blocks before body goes out of scope.
+    std::unique_lock<std::mutex> lock(mMutex);
+    mJobDone.wait(lock, [this]() { return mPending == 0; });
+    mBody = nullptr;
+    if (mError) {
+        std::rethrow_exception(mError);
+    }
+}
+
+void ThreadPool::WorkerLoop(int block) {
+    unsigned seenJob = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mJobReady.wait(lock, [this, seenJob]() { return mStopping || mJobId != seenJob; });
+            if (mStopping) {
+                return;
+            }
+            seenJob = mJobId;
+        }
+
+        RunBlock(block);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (--mPending == 0) {
+            mJobDone.notify_one();
+        }
+    }
+}
+
+void ThreadPool::RunBlock(int block) {
+    // Contiguous blocks of (almost) equal size.
+    size_t begin = mCount * block / mThreadCount;
+    size_t end = mCount * (block + 1) / mThreadCount;
+    try {
+        (*mBody)(begin, end, block);
+    }
+    catch (...) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!mError) {
+            mError = std::current_exception();
+        }
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads that run ParallelFor jobs. The calling thread works on the first block itself.
+class ThreadPool
+{
+public:
+	// A thread count of 0 means one thread per hardware core.
+	explicit ThreadPool(int threadCount = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	int GetThreadCount() const { return mThreadCount; }
+
+	// Splits [0, count) into one contiguous block per thread and calls body(begin, end, block) for each block.
+	// The block boundaries only depend on count and the thread count. Returns once every block is done and
+	// rethrows the first exception thrown by a block.
+	void ParallelFor(size_t count, const std::function<void(size_t, size_t, int)>& body);
+
+private:
+	void WorkerLoop(int block);
+	void RunBlock(int block);
+
+	int mThreadCount = 1;
+	std::vector<std::thread> mWorkers;
+
+	std::mutex mMutex;
+	std::condition_variable mJobReady;
+	std::condition_variable mJobDone;
+	const std::function<void(size_t, size_t, int)>* mBody = nullptr;
+	size_t mCount = 0;
+	unsigned mJobId = 0;
+	int mPending = 0;
+	bool mStopping = false;
+	std::exception_ptr mError;
+};
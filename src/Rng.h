@@ -0,0 +1,204 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+
+// Function that mixes a 64-bit value into a well distributed 64-bit value (the SplitMix64 finalizer).
+inline uint64_t MixBits(uint64_t x)
+{
+	x ^= x >> 30;
+	x *= 0xBF58476D1CE4E5B9ull;
+	x ^= x >> 27;
+	x *= 0x94D049BB133111EBull;
+	x ^= x >> 31;
+	return x;
+}
+
+// Function that derives the seed of an independent random stream from the run seed and two stream coordinates
+// (for example the generation number and the thread index), so every stream is reproducible from the seed alone.
+inline uint64_t DeriveStreamSeed(uint64_t seed, uint64_t a, uint64_t b)
+{
+	return MixBits(MixBits(MixBits(seed) + a) + b);
+}
+
+// SplitMix64: a tiny, fast generator with 8 bytes of state. It satisfies UniformRandomBitGenerator,
+// so it works with std::shuffle and the std distributions.
+class SplitMix64
+{
+public:
+	using result_type = uint64_t;
+
+	explicit SplitMix64(uint64_t seed = 0) : mState(seed) {}
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+	result_type operator()()
+	{
+		mState += 0x9E3779B97F4A7C15ull;
+		return MixBits(mState);
+	}
+
+private:
+	uint64_t mState;
+};
+
+// Philox4x32-10: a counter-based generator (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3"). The output
+// is a pure function of the key and the counter, so a stream keyed by (seed, generation, child) gives the same numbers
+// no matter which thread draws them or in which order the children are built.
+class Philox4x32
+{
+public:
+	using result_type = uint32_t;
+
+	Philox4x32(uint64_t seed, uint32_t generation, uint32_t child)
+		: mKey{ static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32) }, mCounter{ 0, child, generation, 0 }
+	{
+	}
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+	result_type operator()()
+	{
+		if (mUsed == 4)
+		{
+			Refill();
+		}
+		return mBlock[mUsed++];
+	}
+
+private:
+	// Computes the next block of four outputs and moves on to the next counter.
+	void Refill()
+	{
+		uint32_t counter[4] = { mCounter[0], mCounter[1], mCounter[2], mCounter[3] };
+		uint32_t key[2] = { mKey[0], mKey[1] };
+		for (int round = 0; round < 10; round++)
+		{
+			uint64_t product0 = static_cast<uint64_t>(0xD2511F53u) * counter[0];
+			uint64_t product1 = static_cast<uint64_t>(0xCD9E8D57u) * counter[2];
+			uint32_t next[4] = {
+				static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+				static_cast<uint32_t>(product1),
+				static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+				static_cast<uint32_t>(product0)
+			};
+			counter[0] = next[0];
+			counter[1] = next[1];
+			counter[2] = next[2];
+			counter[3] = next[3];
+			key[0] += 0x9E3779B9u;
+			key[1] += 0xBB67AE85u;
+		}
+		for (int i = 0; i < 4; i++)
+		{
+			mBlock[i] = counter[i];
+		}
+		mUsed = 0;
+		++mCounter[0];
+	}
+
+	uint32_t mKey[2];
+	uint32_t mCounter[4];
+	uint32_t mBlock[4] = { 0, 0, 0, 0 };
+	int mUsed = 4;
+};
+
+// Function that rotates the bits of x left by k (0 < k < 64).
+inline uint64_t RotateLeft(uint64_t x, int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+// Function that returns the upper 64 bits of the 128-bit product a * b, without relying on a compiler 128-bit type.
+inline uint64_t MultiplyHigh(uint64_t a, uint64_t b)
+{
+	uint64_t aLow = a & 0xFFFFFFFFull;
+	uint64_t aHigh = a >> 32;
+	uint64_t bLow = b & 0xFFFFFFFFull;
+	uint64_t bHigh = b >> 32;
+	uint64_t middle = aHigh * bLow + ((aLow * bLow) >> 32) + ((aLow * bHigh) & 0xFFFFFFFFull);
+	return aHigh * bHigh + (middle >> 32) + ((aLow * bHigh) >> 32);
+}
+
+// xoshiro256** (Blackman and Vigna): 32 bytes of state and a few instructions per 64-bit output. The state is filled
+// from the seed with SplitMix64, as its authors recommend.
+class Xoshiro256StarStar
+{
+public:
+	using result_type = uint64_t;
+
+	explicit Xoshiro256StarStar(uint64_t seed = 0)
+	{
+		SplitMix64 seeder(seed);
+		for (uint64_t& word : mState)
+		{
+			word = seeder();
+		}
+	}
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+	result_type operator()()
+	{
+		uint64_t result = RotateLeft(mState[1] * 5, 7) * 9;
+		uint64_t shifted = mState[1] << 17;
+		mState[2] ^= mState[0];
+		mState[3] ^= mState[1];
+		mState[1] ^= mState[2];
+		mState[0] ^= mState[3];
+		mState[2] ^= shifted;
+		mState[3] = RotateLeft(mState[3], 45);
+		return result;
+	}
+
+private:
+	uint64_t mState[4];
+};
+
+// PCG64 (O'Neill's PCG XSL RR 128/64): a 128-bit linear congruential state whose high and low halves are xor-folded and
+// rotated into each output. The 128-bit arithmetic is done on two 64-bit halves so it builds on every compiler.
+class Pcg64
+{
+public:
+	using result_type = uint64_t;
+
+	// Seeds the generator like pcg64_srandom_r(seed, stream) of the reference implementation.
+	explicit Pcg64(uint64_t seed = 0, uint64_t stream = 0xDA3E39CB94B95BDBull)
+		: mIncrementHigh(stream >> 63), mIncrementLow((stream << 1) | 1)
+	{
+		Step();
+		mStateLow += seed;
+		mStateHigh += mStateLow < seed ? 1 : 0;
+		Step();
+	}
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+	result_type operator()()
+	{
+		Step();
+		int rotation = static_cast<int>(mStateHigh >> 58);
+		uint64_t folded = mStateHigh ^ mStateLow;
+		return rotation == 0 ? folded : (folded >> rotation) | (folded << (64 - rotation));
+	}
+
+private:
+	// Advances the state: state = state * multiplier + increment (mod 2^128).
+	void Step()
+	{
+		const uint64_t multiplierHigh = 2549297995355413924ull;
+		const uint64_t multiplierLow = 4865540595714422341ull;
+		uint64_t high = MultiplyHigh(mStateLow, multiplierLow) + mStateLow * multiplierHigh + mStateHigh * multiplierLow;
+		uint64_t low = mStateLow * multiplierLow;
+		mStateLow = low + mIncrementLow;
+		mStateHigh = high + mIncrementHigh + (mStateLow < low ? 1 : 0);
+	}
+
+	uint64_t mStateHigh = 0;
+	uint64_t mStateLow = 0;
+	uint64_t mIncrementHigh;
+	uint64_t mIncrementLow;
+};
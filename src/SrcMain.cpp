@@ -2,31 +2,231 @@
 #include <iostream>
 #include <random>
 #include "TSP.h"
+#include "Distance.h"
+#include "Diversity.h"
+#include "Clusters.h"
+#include "TspLib.h"
 #include <fstream>
 #include <algorithm>
+#include <stdexcept>
 
-// A function to process the command line arguments and initiate the genetic algorithm.
-void ProcessCommandArgs(int argc, const char* argv[]) {
+// A function to parse the optional --name=value arguments that follow the five required ones.
+static GAOptions ParseGAOptions(int argc, const char* argv[]) {
+	GAOptions options;
+	for (int i = 6; i < argc; i++) {
+		std::string arg = argv[i];
+		size_t equals = arg.find('=');
+		std::string name = arg.substr(0, equals);
+		std::string value = equals == std::string::npos ? "" : arg.substr(equals + 1);
 
-    // Parsing the input command line arguments.
-	std::string inputFile = argv[1]; // The first argument is the file name for the input file.
-	std::string popSizeStr = argv[2]; // The second argument is the population size for the genetic algorithm.
-	int popSizeInt = stoi(popSizeStr); // Converting the population size to an integer.
-	std::string numGenerationsStr = argv[3]; // The third argument is the number of generations the genetic algorithm should run for.
-	int numGenerationsInt = stoi(numGenerationsStr); // Converting the number of generations to an integer.
-	std::string mutationChanceStr = argv[4]; // The fourth argument is the chance of a mutation happening.
-	int mutationChanceInt = stoi(mutationChanceStr); // Converting the mutation chance to an integer.
-	std::string seedStr = argv[5]; // The fifth argument is the seed for the random number generator.
-	int seedInt = stoi(seedStr) ; // Converting the seed to an integer.
+		if (name == "--ranking" && value == "sort") {
+			options.mRanking = RankingMode::FullSort;
+		}
+		else if (name == "--ranking" && value == "partial") {
+			options.mRanking = RankingMode::Partial;
+		}
+		else if (name == "--ranking" && value == "radix") {
+			options.mRanking = RankingMode::Radix;
+		}
+		else if (name == "--selection" && value == "roulette") {
+			options.mSelection = SelectionMode::Roulette;
+		}
+		else if (name == "--selection" && value == "sus") {
+			options.mSelection = SelectionMode::Universal;
+		}
+		else if (name == "--selection" && value == "tournament") {
+			options.mSelection = SelectionMode::Tournament;
+		}
+		else if (name == "--crossover" && value == "splice") {
+			options.mCrossover = CrossoverMode::Splice;
+		}
+		else if (name == "--crossover" && value == "ox1") {
+			options.mCrossover = CrossoverMode::Order;
+		}
+		else if (name == "--crossover" && value == "pmx") {
+			options.mCrossover = CrossoverMode::PartiallyMapped;
+		}
+		else if (name == "--crossover" && value == "eax") {
+			options.mCrossover = CrossoverMode::EdgeAssembly;
+		}
+		else if (name == "--crossover" && value == "eax-local") {
+			options.mCrossover = CrossoverMode::EdgeAssemblyLocal;
+		}
+		else if (name == "--crossover" && value == "greedy") {
+			options.mCrossover = CrossoverMode::Greedy;
+		}
+		else if (name == "--mutation" && value == "swap") {
+			options.mMutation = MutationMode::Swap;
+		}
+		else if (name == "--mutation" && value == "inversion") {
+			options.mMutation = MutationMode::Inversion;
+		}
+		else if (name == "--adaptive-mutation" && (value == "on" || value == "off")) {
+			options.mAdaptiveMutation = value == "on";
+		}
+		else if (name == "--mutation-min" && stoi(value) >= 0 && stoi(value) <= 100) {
+			options.mMutationMin = stoi(value);
+		}
+		else if (name == "--mutation-max" && stoi(value) >= 0 && stoi(value) <= 100) {
+			options.mMutationMax = stoi(value);
+		}
+		else if (name == "--initial-tours" && value == "shuffle") {
+			options.mInitialTours = InitialTourMode::Shuffle;
+		}
+		else if (name == "--initial-tours" && value == "hilbert") {
+			options.mInitialTours = InitialTourMode::Hilbert;
+		}
+		else if (name == "--initial-tours" && value == "cheapest") {
+			options.mInitialTours = InitialTourMode::CheapestInsertion;
+		}
+		else if (name == "--initial-tours" && value == "farthest") {
+			options.mInitialTours = InitialTourMode::FarthestInsertion;
+		}
+		else if (name == "--initial-tours" && value == "hull") {
+			options.mInitialTours = InitialTourMode::ConvexHull;
+		}
+		else if (name == "--initial-tours" && value == "christofides") {
+			options.mInitialTours = InitialTourMode::Christofides;
+		}
+		else if (name == "--seeding" && value == "random") {
+			options.mSeeding = SeedingMode::Random;
+		}
+		else if (name == "--seeding" && value == "nn") {
+			options.mSeeding = SeedingMode::NearestNeighbor;
+		}
+		else if (name == "--seeding" && value == "greedy") {
+			options.mSeeding = SeedingMode::GreedyEdge;
+		}
+		else if (name == "--seeding-fraction" && stod(value) >= 0.0 && stod(value) <= 1.0) {
+			options.mSeedingFraction = stod(value);
+		}
+		else if (name == "--candidates" && stoi(value) >= 1) {
+			options.mCandidates = stoi(value);
+		}
+		else if (name == "--candidate-set" && value == "nearest") {
+			options.mCandidateSet = CandidateSet::Nearest;
+		}
+		else if (name == "--candidate-set" && value == "delaunay") {
+			options.mCandidateSet = CandidateSet::Delaunay;
+		}
+		else if (name == "--candidate-set" && value == "delaunay+quadrant") {
+			options.mCandidateSet = CandidateSet::DelaunayQuadrant;
+		}
+		else if (name == "--tournament-size" && stoi(value) >= 1) {
+			options.mTournamentSize = stoi(value);
+		}
+		else if (name == "--threads" && stoi(value) >= 0) {
+			options.mThreads = stoi(value);
+		}
+		else if (name == "--parallel-crossover" && (value == "on" || value == "off")) {
+			options.mParallelCrossover = value == "on";
+		}
+		else if (name == "--parallel-init" && (value == "on" || value == "off")) {
+			options.mParallelInit = value == "on";
+		}
+		else if (name == "--rng" && value == "mt19937") {
+			options.mEngine = RngEngine::Mt19937;
+		}
+		else if (name == "--rng" && value == "xoshiro") {
+			options.mEngine = RngEngine::Xoshiro;
+		}
+		else if (name == "--rng" && value == "pcg64") {
+			options.mEngine = RngEngine::Pcg64;
+		}
+		else if (name == "--local-search" && value == "none") {
+			options.mLocalSearch = LocalSearchMode::None;
+		}
+		else if (name == "--local-search" && value == "2opt") {
+			options.mLocalSearch = LocalSearchMode::TwoOpt;
+		}
+		else if (name == "--local-search" && value == "oropt") {
+			options.mLocalSearch = LocalSearchMode::OrOpt;
+		}
+		else if (name == "--local-search" && value == "2opt+oropt") {
+			options.mLocalSearch = LocalSearchMode::TwoOptOrOpt;
+		}
+		else if (name == "--local-search" && value == "lk") {
+			options.mLocalSearch = LocalSearchMode::LinKernighan;
+		}
+		else if (name == "--solver" && value == "ga") {
+			options.mSolver = SolverMode::Genetic;
+		}
+		else if (name == "--solver" && value == "lk") {
+			options.mSolver = SolverMode::LinKernighan;
+		}
+		else if (name == "--solver" && value == "clusters") {
+			options.mSolver = SolverMode::Clusters;
+		}
+		else if (name == "--cluster-size" && stoi(value) >= 8) {
+			options.mClusterSize = stoi(value);
+		}
+		else if (name == "--polish" && (value == "none" || value == "lk")) {
+			options.mPolish = value == "lk";
+		}
+		else if (name == "--local-search-fraction" && stod(value) >= 0.0 && stod(value) <= 1.0) {
+			options.mLocalSearchFraction = stod(value);
+		}
+		else if (name == "--local-search-budget" && stoi(value) >= 0) {
+			options.mLocalSearchBudget = stoi(value);
+		}
+		else {
+			throw std::invalid_argument("Unknown option: " + arg);
+		}
+	}
+	if (options.mMutationMin > options.mMutationMax) {
+		throw std::invalid_argument("--mutation-min must not be larger than --mutation-max");
+	}
+	return options;
+}
 
-    // Initializing the random number generator with the given seed.
-	std::mt19937 generator(seedInt);
+// A function that runs the genetic algorithm with the given random engine and logs every step to "log.txt".
+template <typename Engine>
+static void RunGeneticAlgorithm(Engine generator, const std::string& inputFile, int popSizeInt, int numGenerationsInt, int mutationChanceInt, int seedInt, const GAOptions& options) {
+    // Worker threads for the parallel operators.
+	ThreadPool pool(options.mThreads);
 
-    // Reading the locations from the input file.
-	std::vector<Location> locations = ReadLocations(inputFile);
+    // Reading the locations from the input file, in chunks on the worker threads, or a TSPLIB instance, which brings its
+    // own distance function or matrix.
+	TspLibInstance instance;
+	if (IsTspLibFile(inputFile)) {
+		instance = ReadTspLib(inputFile);
+	}
+	else {
+		instance.mLocations = ReadLocations(inputFile, pool);
+	}
+	const std::vector<Location>& locations = instance.mLocations;
+
+    // An explicit instance without display data has no placement of its locations for the geometric constructions.
+	if (!instance.mHasGeometry && (options.mInitialTours == InitialTourMode::Hilbert || options.mInitialTours == InitialTourMode::FarthestInsertion || options.mInitialTours == InitialTourMode::ConvexHull)) {
+		throw std::invalid_argument("--initial-tours=hilbert, farthest and hull need coordinates, and this explicit instance has no DISPLAY_DATA_SECTION");
+	}
+
+    // The distances between the locations, with candidate neighbor lists if an operator needs them.
+	DistanceStore distances = MakeDistanceStore(instance);
+	if (NeedsCandidates(options)) {
+		distances.BuildCandidates(options.mCandidates, options.mCandidateSet);
+	}
+
+    // The fitnesses are the Haversine lengths of the tours in miles, or their lengths by the TSPLIB distances (in the
+    // file's own unit).
+	auto fitnessesOf = [&](const Population& pop) {
+		return instance.mMetric == DistanceMetric::Haversine ? computeFitnesses(pop, locations) : computeFitnesses(pop, distances);
+	};
+	std::string_view unit = instance.mMetric == DistanceMetric::Haversine ? "miles" : "";
+
+    // The cluster solver runs the genetic algorithm on every cluster of the locations and only logs the joined tour.
+	if (options.mSolver == SolverMode::Clusters) {
+		Population best;
+		best.mMembers.push_back(SolveByClusters<Engine>(locations, distances, popSizeInt, numGenerationsInt, mutationChanceInt, seedInt, options, pool));
+		OutputSolution("log.txt", locations, best.mMembers[0], fitnessesOf(best)[0].second, unit);
+		return;
+	}
 
     // Creating the initial population.
-	Population initialPopulation = FillInitialPopulation(popSizeInt, generator, locations.size());
+	Population initialPopulation = options.mParallelInit
+		? ParallelFillInitialPopulation(popSizeInt, seedInt, locations, distances, options.mInitialTours, pool)
+		: FillInitialPopulation(popSizeInt, generator, locations, distances, options.mInitialTours);
+	SeedInitialPopulation(initialPopulation, generator, distances, options.mSeeding, options.mSeedingFraction);
 
     // Logging the initial population to a file named "log.txt".
 	OutputPopulationFile("log.txt", initialPopulation, "INITIAL POPULATION:");
@@ -34,25 +234,38 @@ void ProcessCommandArgs(int argc, const char* argv[]) {
     // Declarations of populationFitnesses and selections to be used in the genetic algorithm.
 	std::vector<std::pair<int,double>> populationFitnesses;
 	std::vector<std::pair<int,int>> selections;
+	DiversityScratch diversityScratch;
+
+    // The standalone Lin-Kernighan solver improves every initial tour to a local optimum instead of running generations,
+    // and logs the improved tours after the initial ones.
+	if (options.mSolver == SolverMode::LinKernighan) {
+		PolishTours(initialPopulation, distances, pool);
+		OutputPopulationFile("log.txt", initialPopulation, "POLISHED POPULATION:", true);
+		numGenerationsInt = 0;
+	}
 
     // Running the genetic algorithm for the specified number of generations.
 	for (int genNumber = 1; genNumber <= numGenerationsInt; genNumber++ ) {
 	    // Computing the fitnesses for the current population.
-	    populationFitnesses = computeFitnesses(initialPopulation, locations);
+	    populationFitnesses = fitnessesOf(initialPopulation);
 	    // Logging the fitnesses to the "log.txt" file.
 	    OutputFitnessFile("log.txt",populationFitnesses);
-	    // Performing the selection step of the genetic algorithm.
-	    selections = Select(populationFitnesses, generator, popSizeInt);
+	    // Steering the mutation chance by the population's diversity, and logging the decision.
+	    if (options.mAdaptiveMutation) {
+	        DiversityMetrics metrics = MeasureDiversity(initialPopulation, diversityScratch);
+	        mutationChanceInt = AdaptMutationChance(metrics, popSizeInt, mutationChanceInt, options);
+	        OutputDiversity("log.txt", metrics, mutationChanceInt);
+	    }
+	    // Selecting the parents and generating the new population by crossover (and possibly mutation).
+	    initialPopulation = NextGeneration(populationFitnesses, initialPopulation, locations, generator, seedInt, genNumber, popSizeInt, mutationChanceInt, options, distances, pool, selections);
 	    // Logging the selected pairs to the "log.txt" file.
 	    OutputSelectedPairs("log.txt",selections);
-	    // Generating the new population by crossover (and possibly mutation).
-	    initialPopulation = Crossover(selections, locations, generator, popSizeInt, initialPopulation, mutationChanceInt);
 	    // Logging the current generation to the "log.txt" file.
 	    OutputGeneration("log.txt", genNumber, initialPopulation);
 	}
 
     // Computing the fitnesses for the final population.
-	populationFitnesses = computeFitnesses(initialPopulation, locations);
+	populationFitnesses = fitnessesOf(initialPopulation);
 
     // Logging the final fitnesses to the "log.txt" file.
 	OutputFitnessFile("log.txt",populationFitnesses);
@@ -69,6 +282,44 @@ void ProcessCommandArgs(int argc, const char* argv[]) {
     // Getting the route with the minimum distance.
 	auto minDistanceVector= initialPopulation.mMembers[minDistanceElement];
 
+    // Polishing the best route with the Lin-Kernighan search, if asked to.
+	if (options.mPolish) {
+		Population best;
+		best.mMembers.push_back(minDistanceVector);
+		PolishTours(best, distances, pool);
+		minDistanceVector = best.mMembers[0];
+		minDistance = fitnessesOf(best)[0].second;
+	}
+
     // Logging the best solution found by the genetic algorithm to the "log.txt" file.
-	OutputSolution("log.txt", locations, minDistanceVector, minDistance);
+	OutputSolution("log.txt", locations, minDistanceVector, minDistance, unit);
+}
+
+// A function to process the command line arguments and initiate the genetic algorithm.
+void ProcessCommandArgs(int argc, const char* argv[]) {
+
+    // Parsing the input command line arguments.
+	std::string inputFile = argv[1]; // The first argument is the file name for the input file.
+	std::string popSizeStr = argv[2]; // The second argument is the population size for the genetic algorithm.
+	int popSizeInt = stoi(popSizeStr); // Converting the population size to an integer.
+	std::string numGenerationsStr = argv[3]; // The third argument is the number of generations the genetic algorithm should run for.
+	int numGenerationsInt = stoi(numGenerationsStr); // Converting the number of generations to an integer.
+	std::string mutationChanceStr = argv[4]; // The fourth argument is the chance of a mutation happening.
+	int mutationChanceInt = stoi(mutationChanceStr); // Converting the mutation chance to an integer.
+	std::string seedStr = argv[5]; // The fifth argument is the seed for the random number generator.
+	int seedInt = stoi(seedStr) ; // Converting the seed to an integer.
+	GAOptions options = ParseGAOptions(argc, argv); // Any further arguments are optional settings.
+
+    // Initializing the random number generator with the given seed, and running the genetic algorithm with it.
+	switch (options.mEngine) {
+	case RngEngine::Xoshiro:
+		RunGeneticAlgorithm(Xoshiro256StarStar(seedInt), inputFile, popSizeInt, numGenerationsInt, mutationChanceInt, seedInt, options);
+		break;
+	case RngEngine::Pcg64:
+		RunGeneticAlgorithm(Pcg64(seedInt), inputFile, popSizeInt, numGenerationsInt, mutationChanceInt, seedInt, options);
+		break;
+	default:
+		RunGeneticAlgorithm(std::mt19937(seedInt), inputFile, popSizeInt, numGenerationsInt, mutationChanceInt, seedInt, options);
+		break;
+	}
 }
@@ -1,64 +1,64 @@
 #include "TSP.h"
+#include "Operators.h"
+#include "Distance.h"
+#include "LocalSearch.h"
+#include "Construction.h"
+#include "LocationFile.h"
+#include <stdexcept>
 #include <fstream>
 #include <algorithm>
 #include <cmath>
 #include <iterator>
 #include <numeric>
 #include <iostream>
+#include <cstdint>
+#include <cstring>
 
 // function that returns a std::vector of locations. This function needs to read in the locations from the input file.
 std::vector<Location> ReadLocations(std::string_view inputFile) {
+    // Parsing the memory-mapped file, with the names as views into it.
+    MappedFile file(inputFile);
+    std::vector<LocationRecord> records;
+    ParseLocations(file.Text(), records);
+
+    // Copying the records into locations that own their names, since the mapping closes when this function returns.
+    std::vector<Location> locations(records.size());
+    for (size_t i = 0; i < records.size(); i++) {
+        locations[i].mName = records[i].mName;
+        locations[i].mLatitude = records[i].mLatitude;
+        locations[i].mLongitude = records[i].mLongitude;
+    }
+    return locations;
+}
 
-    std::ifstream in(inputFile.data());
-	std::string line;
-
-    std::vector<Location> locations;
-
-    if (in.is_open()) {
-		while (!in.eof()) {
-
-			std::getline(in, line);
-            
-            int comma = line.find(',');
-
-            std::string name = line.substr(0, comma);
-            line.erase(0, comma + 1);
-
-            comma = line.find(',');
-
-            double latitude = stod(line.substr(0, comma));
-
-
-            line.erase(0, comma + 1);
-
-            comma = line.find(',');
-
-            double longitude = stod(line.substr(0, comma));
-
-            line.erase(0,  + comma + 1);
-
-            Location loc;
-            loc.mName = name;
-            loc.mLatitude = latitude;
-            loc.mLongitude = longitude;
-
-
-            locations.emplace_back(loc);
-
-
-
-
-
-		}
-	}
-
+// Function that reads the locations on the thread pool: every chunk of the file is parsed, then copied to its place in the
+// result, by its own thread, so the city indices are the same as with the serial reading.
+std::vector<Location> ReadLocations(std::string_view inputFile, ThreadPool& pool) {
+    MappedFile file(inputFile);
+    std::vector<std::vector<LocationRecord>> chunks;
+    ParallelParseLocations(file.Text(), pool, chunks);
 
+    std::vector<size_t> offsets(chunks.size() + 1, 0);
+    for (size_t i = 0; i < chunks.size(); i++) {
+        offsets[i + 1] = offsets[i] + chunks[i].size();
+    }
+    std::vector<Location> locations(offsets.back());
+    pool.ParallelFor(chunks.size(), [&](size_t begin, size_t end, int) {
+        for (size_t i = begin; i < end; i++) {
+            for (size_t j = 0; j < chunks[i].size(); j++) {
+                Location& location = locations[offsets[i] + j];
+                location.mName = chunks[i][j].mName;
+                location.mLatitude = chunks[i][j].mLatitude;
+                location.mLongitude = chunks[i][j].mLongitude;
+            }
+        }
+    });
     return locations;
-
 }
 
 // Function that generates the initial population for the genetic algorithm. The population consists of various permutations of the route sequence.
-Population FillInitialPopulation (int popSize, std::mt19937& generator, size_t locationSize) {
+template <typename Engine>
+Population FillInitialPopulation (int popSize, Engine& generator, size_t locationSize) {
     // Creating a population vector with size as the population size.
     std::vector<std::vector<int>> populations(popSize);
 
@@ -82,15 +82,115 @@ Population FillInitialPopulation (int popSize, std::mt19937& generator, size_t l
 
     // Create a Population object and assign the generated population to its member field.
     Population pop;
-    pop.mMembers = populations;
+    pop.mMembers = std::move(populations);
 
     // Return the created population object.
     return pop;
 }
 
+// Function that builds one constructed tour: the plain construction, or one perturbed by seed (Hilbert shifts and mirrors
+// the curve, the heuristics add up to 10% of noise to their keys).
+static void ConstructTour(InitialTourMode mode, bool plain, uint64_t seed, const std::vector<ProjectedPoint>& points, const DistanceStore& distances,
+                          ConstructionScratch& scratch, std::vector<int>& tour) {
+    double noise = plain ? 0.0 : 0.1;
+    switch (mode) {
+    case InitialTourMode::Hilbert:
+        HilbertTour(points, plain ? 0.0 : 1.0, seed, scratch, tour);
+        break;
+    case InitialTourMode::CheapestInsertion:
+        CheapestInsertionTour(distances, noise, seed, scratch, tour);
+        break;
+    case InitialTourMode::FarthestInsertion:
+        FarthestInsertionTour(distances, points, noise, seed, scratch, tour);
+        break;
+    case InitialTourMode::ConvexHull:
+        ConvexHullInsertionTour(distances, points, noise, seed, scratch, tour);
+        break;
+    default:
+        ChristofidesTour(distances, noise, seed, scratch, tour);
+        break;
+    }
+}
+
+// Function that builds the initial population with the given construction. Shuffle draws exactly what the overload above
+// draws. The others give member 0 the plain construction and every other member one perturbed by a seed drawn from the
+// generator. The insertion heuristics and Christofides need the candidate lists.
+template <typename Engine>
+Population FillInitialPopulation(int popSize, Engine& generator, const std::vector<Location>& locations, const DistanceStore& distances, InitialTourMode mode) {
+    if (mode == InitialTourMode::Shuffle) {
+        return FillInitialPopulation(popSize, generator, locations.size());
+    }
+
+    Population pop;
+    pop.mMembers.resize(popSize);
+    std::vector<ProjectedPoint> points = ProjectLocations(locations);
+    std::uniform_int_distribution<uint64_t> seed;
+    ConstructionScratch scratch;
+    for (int i = 0; i < popSize; i++) {
+        ConstructTour(mode, i == 0, seed(generator), points, distances, scratch, pop.mMembers[i]);
+    }
+    return pop;
+}
+
+// This function is a parallel version of FillInitialPopulation. Every member draws from its own counter-based stream
+// keyed by (seed, generation 0, member index), so the population is identical for any thread count and block split. Each
+// member is written in place at its final size, without the temporary the sequential version builds.
+Population ParallelFillInitialPopulation(int popSize, uint64_t seed, const std::vector<Location>& locations, const DistanceStore& distances,
+                                         InitialTourMode mode, ThreadPool& pool) {
+    Population pop;
+    pop.mMembers.resize(popSize);
+    std::vector<ProjectedPoint> points;
+    if (mode != InitialTourMode::Shuffle) {
+        points = ProjectLocations(locations);
+    }
+
+    pool.ParallelFor(popSize, [&](size_t begin, size_t end, int) {
+        ConstructionScratch scratch; // Scratch space shared by the members of this block.
+        for (size_t member = begin; member < end; member++) {
+            Philox4x32 generator(seed, 0, static_cast<uint32_t>(member));
+            std::vector<int>& tour = pop.mMembers[member];
+            if (mode == InitialTourMode::Shuffle) {
+                tour.resize(locations.size());
+                std::iota(tour.begin(), tour.end(), 0);
+                if (tour.size() > 1) {
+                    std::shuffle(tour.begin() + 1, tour.end(), generator);
+                }
+            }
+            else {
+                uint64_t memberSeed = (static_cast<uint64_t>(generator()) << 32) | generator();
+                ConstructTour(mode, member == 0, memberSeed, points, distances, scratch, tour);
+            }
+        }
+    });
+
+    return pop;
+}
+
+// Function that replaces the first ceil(fraction * popSize) members of a random initial population with constructed
+// tours: nearest-neighbor tours from random start cities, or greedy edge tours whose edge lengths get up to 10% of random
+// noise (except the first one). The other members and their random draws stay as FillInitialPopulation made them.
+template <typename Engine>
+void SeedInitialPopulation(Population& pop, Engine& generator, const DistanceStore& distances, SeedingMode seeding, double fraction) {
+    if (seeding == SeedingMode::Random || distances.Size() < 2) {
+        return;
+    }
+    size_t count = std::min(pop.mMembers.size(), static_cast<size_t>(std::ceil(fraction * pop.mMembers.size())));
+    std::uniform_int_distribution<int> start(0, static_cast<int>(distances.Size()) - 1);
+    std::uniform_int_distribution<uint64_t> seed;
+    ConstructionScratch scratch;
+    for (size_t i = 0; i < count; i++) {
+        if (seeding == SeedingMode::NearestNeighbor) {
+            NearestNeighborTour(distances, start(generator), scratch, pop.mMembers[i]);
+        }
+        else {
+            GreedyEdgeTour(distances, i == 0 ? 0.0 : 0.1, seed(generator), scratch, pop.mMembers[i]);
+        }
+    }
+}
+
 // this function outputs the population to output file for testing purposes
-void OutputPopulationFile(std::string_view fileName, const Population& pop, std::string_view header) {
-    std::ofstream out(fileName.data());
+void OutputPopulationFile(std::string_view fileName, const Population& pop, std::string_view header, bool append) {
+    std::ofstream out(fileName.data(), append ? std::ios_base::app : std::ios_base::out);
 
 
     out << header.data() << '\n';
@@ -160,6 +260,15 @@ std::vector<std::pair<int,double>> computeFitnesses(const Population& population
     return fitnesses;
 }
 
+// Function that computes the fitness of every member as its tour length in the distance store.
+std::vector<std::pair<int,double>> computeFitnesses(const Population& population, const DistanceStore& distances) {
+    std::vector<std::pair<int,double>> fitnesses(population.mMembers.size());
+    for (size_t i = 0; i < fitnesses.size(); i++) {
+        fitnesses[i] = std::make_pair(static_cast<int>(i), distances.TourLength(population.mMembers[i]));
+    }
+    return fitnesses;
+}
+
 
 // Function to compute the Haversine distance between two locations given their longitudes and latitudes.
 double GetHaversineDistance(const double& lon1, const double& lat1, const double& lon2, const double& lat2) {
@@ -184,12 +293,22 @@ double GetHaversineDistance(const double& lon1, const double& lat1, const double
 
 
 
-// Function to select parents for the next generation based on the fitness values of the population members. 
-std::vector<std::pair<int,int>> Select(std::vector<std::pair<int,double>>& fitnesses, std::mt19937& generator, int popSize) {
-    // Sort the fitness vector in ascending order. The individual with the lowest score (shortest distance) is considered as the "most fit".
-    std::sort(fitnesses.begin(), fitnesses.end(), [](std::pair<int,double> a, std::pair<int,double> b) {
-        return a.second < b.second;
-    });
+// Function that computes the chance of each population member (by index) to be selected as a parent, based on its fitness rank.
+std::vector<double> RankProbabilities(std::vector<std::pair<int,double>>& fitnesses, int popSize, RankingMode ranking) {
+    // Rank the fitness vector so the individual with the lowest score (shortest distance) comes first, it is considered as the "most fit".
+    // Only ranks 0 and 1 and the membership of ranks 2..popSize/2-1 matter for the weights below, so the partial ranking is O(popSize).
+    // The full sort is kept as the default because the order it gives tied fitnesses is what the sample output logs were made with.
+    if (ranking == RankingMode::Partial) {
+        RankTopHalf(fitnesses, popSize / 2);
+    }
+    else if (ranking == RankingMode::Radix) {
+        RadixSortFitnesses(fitnesses);
+    }
+    else {
+        std::sort(fitnesses.begin(), fitnesses.end(), [](std::pair<int,double> a, std::pair<int,double> b) {
+            return a.second < b.second;
+        });
+    }
 
     std::vector<double> probabilities(popSize);
 
@@ -214,12 +333,20 @@ std::vector<std::pair<int,int>> Select(std::vector<std::pair<int,double>>& fitne
 
     probabilities = divEachBy(probabilities, probSum);  // Note: The function "divEachBy" should divide each element in the probabilities vector by probSum.
 
+    return probabilities;
+}
+
+// Function to select parents for the next generation based on the fitness values of the population members. 
+template <typename Engine>
+std::vector<std::pair<int,int>> Select(std::vector<std::pair<int,double>>& fitnesses, Engine& generator, int popSize, RankingMode ranking) {
+    std::vector<double> probabilities = RankProbabilities(fitnesses, popSize, ranking);
+
     std::vector<std::pair<int,int>> selections(popSize);
 
     // Generate a pair of parents for each new individual in the next generation.
-    std::generate(selections.begin(), selections.end(), [&generator, &probabilities]() {
+    std::uniform_real_distribution<double> uniformDist(0.0, 1.0);
+    std::generate(selections.begin(), selections.end(), [&generator, &probabilities, &uniformDist]() {
         std::pair<int,int> parents;
-        std::uniform_real_distribution<double> uniformDist(0.0, 1.0);
 
         // Select the first parent using roulette wheel selection. This means that individuals with higher fitness have a higher chance of being selected.
         double randDouble = uniformDist(generator);
@@ -257,6 +384,108 @@ std::vector<std::pair<int,int>> Select(std::vector<std::pair<int,double>>& fitne
 }
 
 
+// Function to select parents with stochastic universal sampling instead of one roulette spin per parent. All 2 * popSize parents
+// come from a single random offset: the pointers are evenly spaced over the cumulative probability table, which is swept once.
+// This is O(popSize) in total. The sweep hands out the parents in member order, so they are shuffled before they are
+// paired; pairing them as swept would always mate the first half of the table with the second.
+template <typename Engine>
+std::vector<std::pair<int,int>> SelectUniversal(std::vector<std::pair<int,double>>& fitnesses, Engine& generator, int popSize, RankingMode ranking) {
+    std::vector<double> probabilities = RankProbabilities(fitnesses, popSize, ranking);
+
+    // Build the cumulative table (the same running sum the roulette wheel computes per spin).
+    std::vector<double> cumulative(popSize);
+    std::partial_sum(probabilities.begin(), probabilities.end(), cumulative.begin());
+
+    // Sweep the evenly spaced pointers through the table once.
+    std::uniform_real_distribution<double> uniformDist(0.0, 1.0);
+    double offset = uniformDist(generator);
+    int pointerCount = 2 * popSize;
+    std::vector<int> parents(pointerCount);
+    int i = 0;
+    for (int j = 0; j < pointerCount; j++) {
+        double pointer = (offset + j) / pointerCount;
+        // The last entry may be a rounding error below 1.0, so never step past it.
+        while (cumulative[i] < pointer && i < popSize - 1) {
+            ++i;
+        }
+        parents[j] = i;
+    }
+    std::shuffle(parents.begin(), parents.end(), generator);
+
+    std::vector<std::pair<int,int>> selections(popSize);
+    for (int j = 0; j < popSize; j++) {
+        selections[j] = std::make_pair(parents[j], parents[j + popSize]);
+    }
+
+    // Return the vector of parent pairs for the next generation.
+    return selections;
+}
+
+
+// Function that partially ranks the fitness vector in O(n): afterwards the first topCount entries are the topCount fittest individuals
+// (in no particular order), except that entries 0 and 1 are exactly the fittest and second fittest individual.
+void RankTopHalf(std::vector<std::pair<int,double>>& fitnesses, int topCount) {
+    auto byFitness = [](const std::pair<int,double>& a, const std::pair<int,double>& b) {
+        return a.second < b.second;
+    };
+
+    // Always rank at least the two fittest individuals, but never more than the vector holds.
+    size_t top = std::min(fitnesses.size(), static_cast<size_t>(std::max(topCount, 2)));
+    if (top == 0) {
+        return;
+    }
+
+    // Move the top individuals to the front of the vector.
+    if (top < fitnesses.size()) {
+        std::nth_element(fitnesses.begin(), fitnesses.begin() + top, fitnesses.end(), byFitness);
+    }
+
+    // A tiny top-2 pass over the front part places the fittest individual at rank 0 and the second fittest at rank 1.
+    std::iter_swap(fitnesses.begin(), std::min_element(fitnesses.begin(), fitnesses.begin() + top, byFitness));
+    if (top > 1) {
+        std::iter_swap(fitnesses.begin() + 1, std::min_element(fitnesses.begin() + 1, fitnesses.begin() + top, byFitness));
+    }
+}
+
+// Function that fully sorts the fitness vector in ascending order of fitness with a stable LSD radix sort on the bits of the keys.
+// This is O(n) per pass and is meant for operators that really need a complete ranking of the population.
+void RadixSortFitnesses(std::vector<std::pair<int,double>>& fitnesses) {
+    // Map each double onto an unsigned integer with the same ordering: positive numbers get their sign bit set,
+    // negative numbers get all of their bits flipped.
+    std::vector<uint64_t> keys(fitnesses.size());
+    std::transform(fitnesses.begin(), fitnesses.end(), keys.begin(), [](const std::pair<int,double>& fit) {
+        uint64_t bits = 0;
+        std::memcpy(&bits, &fit.second, sizeof(bits));
+        return (bits & 0x8000000000000000ull) ? ~bits : (bits | 0x8000000000000000ull);
+    });
+
+    std::vector<std::pair<int,double>> fitsScratch(fitnesses.size());
+    std::vector<uint64_t> keysScratch(keys.size());
+    std::vector<size_t> counts(65537);
+
+    // Sort 16 bits at a time, starting from the least significant ones.
+    for (int shift = 0; shift < 64; shift += 16) {
+        std::fill(counts.begin(), counts.end(), 0);
+        for (uint64_t key : keys) {
+            ++counts[((key >> shift) & 0xFFFF) + 1];
+        }
+
+        // Skip the pass when every key has the same digit (this is common for the high bits of distances).
+        if (*std::max_element(counts.begin(), counts.end()) == keys.size()) {
+            continue;
+        }
+
+        std::partial_sum(counts.begin(), counts.end(), counts.begin());
+        for (size_t i = 0; i < keys.size(); i++) {
+            size_t dest = counts[(keys[i] >> shift) & 0xFFFF]++;
+            keysScratch[dest] = keys[i];
+            fitsScratch[dest] = fitnesses[i];
+        }
+        keys.swap(keysScratch);
+        fitnesses.swap(fitsScratch);
+    }
+}
+
 // Function to divide each element of a vector by a given denominator
 std::vector<double> divEachBy(const std::vector<double>& v, double denominator) {
     std::vector<double> ret;
@@ -286,27 +515,38 @@ void OutputSelectedPairs(std::string_view fileName, const std::vector<std::pair<
     }
 }
 
-// This function implements the crossover and mutation operations for the genetic algorithm.
-// It takes as inputs the pairs of parents selected for crossover, the list of locations, a random number generator, 
-// the size of the population, the current population, and the chance of mutation.
-Population Crossover(const std::vector<std::pair<int,int>>& selections, const std::vector<Location>& locations, std::mt19937& generator, 
-                     int popSize, const Population& currentPop, int mutationChanceInt) {
-
-    std::vector<std::vector<int>> newPop; // Vector to hold the new population.
+// The distributions every child draws from. They only depend on the tour length, so they are built once per
+// population instead of once per child.
+struct ChildDistributions {
+    ChildDistributions(size_t locationSize, int mutationChanceInt)
+        : mSpliceIndex(1, std::max<int>(1, static_cast<int>(locationSize) - 2)),
+          mIndex(1, std::max<int>(1, static_cast<int>(locationSize) - 1)),
+          mCoin(0, 1),
+          mMutationChance(static_cast<double>(mutationChanceInt)/100.0) {
+    }
 
-    // std::transform applies a function to each member of the selections vector.
-    // The function performs crossover between pairs of parents and applies mutation.
-    std::transform(selections.begin(), selections.end(), std::back_inserter(newPop), 
-                   [&generator, popSize, &locations, &currentPop, mutationChanceInt](const std::pair<int,int>& parents) {
-        
+    std::uniform_int_distribution<int> mSpliceIndex; // crossover point of the splice operator
+    std::uniform_int_distribution<int> mIndex;       // any position but the first (segment ends and mutation swaps)
+    std::uniform_int_distribution<int> mCoin;        // which parent goes first
+    std::uniform_int_distribution<uint64_t> mSeed;   // seed for the choices inside EAX
+    std::uniform_real_distribution<double> mUnit;    // mutation roll
+    double mMutationChance;
+};
+
+// This function builds one child from a pair of parents with the chosen crossover operator and possibly mutates it. It is
+// shared by Crossover and the fused selection and crossover pass, and works with any random engine so each thread can draw
+// from its own stream. The scratch buffers are reused across children, so building a child is O(n).
+template <typename Engine>
+static std::vector<int> MakeChild(const std::pair<int,int>& parents, const Population& currentPop, Engine& generator, ChildDistributions& dists,
+                                  CrossoverMode crossover, MutationMode mutation, const DistanceStore* distances, CrossoverScratch& scratch) {
+    std::vector<int> newMem; // Vector to hold the new member of the population.
+
+    if (crossover == CrossoverMode::Splice) {
         // Generate a random index for the crossover point.
-        std::uniform_int_distribution<int> distribution(1, locations.size() - 2);
-        int crossoverIndex = distribution(generator);
-        std::vector<int> newMem; // Vector to hold the new member of the population.
+        int crossoverIndex = dists.mSpliceIndex(generator);
 
         // Randomly select which parent will contribute the first part of the genome.
-        std::uniform_int_distribution<int> binaryOut(0,1);
-        int chooser = binaryOut(generator);
+        int chooser = dists.mCoin(generator);
         int firstParent = 0;
         int secondParent = 0;
         if (chooser == 0) {
@@ -315,31 +555,93 @@ Population Crossover(const std::vector<std::pair<int,int>>& selections, const st
         }
         else {
             firstParent = parents.first;
-            secondParent = parents.second;                                                                                                                           
+            secondParent = parents.second;
+        }
+
+        SpliceCrossover(currentPop.mMembers[firstParent], currentPop.mMembers[secondParent], crossoverIndex, scratch, newMem);
+    }
+    else if (crossover == CrossoverMode::EdgeAssembly || crossover == CrossoverMode::EdgeAssemblyLocal) {
+        if (distances == nullptr || distances->CandidateCount() == 0) {
+            throw std::invalid_argument("Edge assembly crossover needs a distance store with candidate lists");
         }
 
-        // Copy the first part of the genome from the first parent.
-        std::copy_n(currentPop.mMembers[firstParent].begin(), crossoverIndex + 1, std::back_inserter(newMem));
+        // Randomly select which parent the child starts from, and the seed for the choices inside the operator.
+        bool swapParents = dists.mCoin(generator) == 0;
+        uint64_t eaxSeed = dists.mSeed(generator);
+        const std::vector<int>& first = currentPop.mMembers[swapParents ? parents.second : parents.first];
+        const std::vector<int>& second = currentPop.mMembers[swapParents ? parents.first : parents.second];
 
-        // Copy the remaining part of the genome from the second parent, skipping any genes already present.
-        std::copy_if(currentPop.mMembers[secondParent].begin(), currentPop.mMembers[secondParent].end(), std::back_inserter(newMem), [&newMem](const int& i) {
-            return std::find(newMem.begin(), newMem.end(), i) == newMem.end();
-        });
+        EaxStrategy strategy = crossover == CrossoverMode::EdgeAssemblyLocal ? EaxStrategy::Single : EaxStrategy::Random;
+        EdgeAssemblyCrossover(first, second, *distances, strategy, eaxSeed, scratch.mEax, newMem);
+    }
+    else if (crossover == CrossoverMode::Greedy) {
+        if (distances == nullptr) {
+            throw std::invalid_argument("Greedy crossover needs a distance store");
+        }
 
-        // Decide whether to apply mutation.
-        std::uniform_real_distribution<double> mutation;
-        double mutationDoub = mutation(generator);
-        double mutationChance = static_cast<double>(mutationChanceInt)/100.0;
+        // Randomly select which parent breaks ties and fills in when both parental edges are used up.
+        bool swapParents = dists.mCoin(generator) == 0;
+        const std::vector<int>& first = currentPop.mMembers[swapParents ? parents.second : parents.first];
+        const std::vector<int>& second = currentPop.mMembers[swapParents ? parents.first : parents.second];
+        GreedyCrossover(first, second, *distances, scratch, newMem);
+    }
+    else {
+        // Generate the segment of the first parent that the child keeps in place (location 0 is never in it).
+        int begin = dists.mIndex(generator);
+        int end = dists.mIndex(generator);
+        if (begin > end) {
+            std::swap(begin, end);
+        }
 
-        // If the randomly generated value is less than or equal to the mutation chance, apply mutation.
-        if (mutationDoub <= mutationChance) {
-            std::uniform_int_distribution<int> mutationSwap(1, newMem.size() - 1);
-            int randomFirstIndex = mutationSwap(generator);
-            int randomSecondIndex = mutationSwap(generator);
+        // Randomly select which parent keeps its segment.
+        bool swapParents = dists.mCoin(generator) == 0;
+        const std::vector<int>& first = currentPop.mMembers[swapParents ? parents.second : parents.first];
+        const std::vector<int>& second = currentPop.mMembers[swapParents ? parents.first : parents.second];
+
+        if (crossover == CrossoverMode::Order) {
+            OrderCrossover(first, second, begin, end, scratch, newMem);
+        }
+        else {
+            PartiallyMappedCrossover(first, second, begin, end, scratch, newMem);
+        }
+    }
+
+    // Decide whether to apply mutation.
+    double mutationDoub = dists.mUnit(generator);
+
+    // If the randomly generated value is less than or equal to the mutation chance, apply mutation.
+    if (mutationDoub <= dists.mMutationChance) {
+        int randomFirstIndex = dists.mIndex(generator);
+        int randomSecondIndex = dists.mIndex(generator);
+        if (mutation == MutationMode::Inversion) {
+            // Reverse the genes between the two positions, which only replaces the two edges at the segment's ends.
+            InversionMutation(newMem, std::min(randomFirstIndex, randomSecondIndex), std::max(randomFirstIndex, randomSecondIndex));
+        }
+        else {
             std::swap(newMem[randomFirstIndex], newMem[randomSecondIndex]); // Swap two genes to apply mutation.
         }
+    }
+
+    return newMem; // Return the new member of the population.
+}
 
-        return newMem; // Return the new member of the population.
+// This function implements the crossover and mutation operations for the genetic algorithm.
+// It takes as inputs the pairs of parents selected for crossover, the list of locations, a random number generator, 
+// the size of the population, the current population, and the chance of mutation.
+template <typename Engine>
+Population Crossover(const std::vector<std::pair<int,int>>& selections, const std::vector<Location>& locations, Engine& generator, 
+                     int popSize, const Population& currentPop, int mutationChanceInt, CrossoverMode crossover, const DistanceStore* distances, MutationMode mutation) {
+
+    std::vector<std::vector<int>> newPop; // Vector to hold the new population.
+    newPop.reserve(selections.size());
+    CrossoverScratch scratch; // Scratch space shared by all of the children.
+    ChildDistributions dists(currentPop.mMembers.empty() ? 0 : currentPop.mMembers[0].size(), mutationChanceInt);
+
+    // std::transform applies a function to each member of the selections vector.
+    // The function performs crossover between pairs of parents and applies mutation.
+    std::transform(selections.begin(), selections.end(), std::back_inserter(newPop), 
+                   [&generator, &currentPop, &dists, crossover, mutation, distances, &scratch](const std::pair<int,int>& parents) {
+        return MakeChild(parents, currentPop, generator, dists, crossover, mutation, distances, scratch);
     });
 
    Population returnPop; // Create a new Population object.
@@ -348,6 +650,187 @@ Population Crossover(const std::vector<std::pair<int,int>>& selections, const st
    return returnPop; // Return the new population.
 }
 
+// This function is a parallel version of Crossover. Every child draws from its own counter-based stream keyed by
+// (seed, generation, child index), so the new population is identical for any thread count and block split.
+Population ParallelCrossover(const std::vector<std::pair<int,int>>& selections, uint64_t seed, int genNumber, int popSize, const Population& currentPop,
+                             int mutationChanceInt, CrossoverMode crossover, const DistanceStore* distances, ThreadPool& pool, MutationMode mutation) {
+    Population returnPop;
+    returnPop.mMembers.resize(selections.size());
+
+    pool.ParallelFor(selections.size(), [&](size_t begin, size_t end, int) {
+        CrossoverScratch scratch; // Scratch space shared by the children of this block.
+        ChildDistributions dists(currentPop.mMembers.empty() ? 0 : currentPop.mMembers[0].size(), mutationChanceInt);
+        for (size_t child = begin; child < end; child++) {
+            Philox4x32 generator(seed, genNumber, static_cast<uint32_t>(child));
+            returnPop.mMembers[child] = MakeChild(selections[child], currentPop, generator, dists, crossover, mutation, distances, scratch);
+        }
+    });
+
+    return returnPop;
+}
+
+// Function that runs a k-tournament: it draws tournamentSize individuals uniformly at random (with replacement)
+// and returns the index of the fittest one. No ranking of the whole population is needed.
+template <typename Engine>
+static int TournamentPick(const std::vector<std::pair<int,double>>& fitnesses, int tournamentSize, Engine& generator) {
+    std::uniform_int_distribution<size_t> contestant(0, fitnesses.size() - 1);
+    size_t best = contestant(generator);
+    for (int round = 1; round < tournamentSize; round++) {
+        size_t challenger = contestant(generator);
+        if (fitnesses[challenger].second < fitnesses[best].second) {
+            best = challenger;
+        }
+    }
+    return fitnesses[best].first;
+}
+
+// This function fuses tournament selection with crossover and mutation into one parallel pass over the children.
+// Each child draws from its own counter-based stream keyed by (seed, generation, child index), so a run is reproducible
+// for a given seed whatever the thread count. The chosen parents are written to selections so they can still be logged.
+Population TournamentCrossover(const std::vector<std::pair<int,double>>& fitnesses, uint64_t seed, int genNumber, int tournamentSize,
+                               int popSize, const Population& currentPop, int mutationChanceInt, CrossoverMode crossover,
+                               const DistanceStore* distances, ThreadPool& pool, std::vector<std::pair<int,int>>& selections, MutationMode mutation) {
+    Population returnPop;
+    returnPop.mMembers.resize(popSize);
+    selections.resize(popSize);
+
+    pool.ParallelFor(popSize, [&](size_t begin, size_t end, int) {
+        CrossoverScratch scratch;
+        ChildDistributions dists(currentPop.mMembers.empty() ? 0 : currentPop.mMembers[0].size(), mutationChanceInt);
+        for (size_t child = begin; child < end; child++) {
+            Philox4x32 generator(seed, genNumber, static_cast<uint32_t>(child));
+            selections[child].first = TournamentPick(fitnesses, tournamentSize, generator);
+            selections[child].second = TournamentPick(fitnesses, tournamentSize, generator);
+            returnPop.mMembers[child] = MakeChild(selections[child], currentPop, generator, dists, crossover, mutation, distances, scratch);
+        }
+    });
+
+    return returnPop;
+}
+
+
+// This function runs the selection and crossover steps of one generation with the operators chosen in options.
+// The selected parent pairs are written to selections so they can be logged.
+template <typename Engine>
+Population NextGeneration(std::vector<std::pair<int,double>>& fitnesses, const Population& currentPop, const std::vector<Location>& locations, Engine& generator, int seed, int genNumber,
+                          int popSize, int mutationChanceInt, const GAOptions& options, const DistanceStore& distances, ThreadPool& pool,
+                          std::vector<std::pair<int,int>>& selections) {
+    Population children;
+
+    // Tournament selection needs no global ranking, so selection and crossover run as one parallel pass per child.
+    if (options.mSelection == SelectionMode::Tournament) {
+        children = TournamentCrossover(fitnesses, seed, genNumber, options.mTournamentSize, popSize, currentPop, mutationChanceInt, options.mCrossover, &distances, pool, selections, options.mMutation);
+    }
+    else {
+        // Performing the selection step of the genetic algorithm.
+        if (options.mSelection == SelectionMode::Universal) {
+            selections = SelectUniversal(fitnesses, generator, popSize, options.mRanking);
+        }
+        else {
+            selections = Select(fitnesses, generator, popSize, options.mRanking);
+        }
+
+        // Generating the new population by crossover (and possibly mutation).
+        if (options.mParallelCrossover) {
+            children = ParallelCrossover(selections, seed, genNumber, popSize, currentPop, mutationChanceInt, options.mCrossover, &distances, pool, options.mMutation);
+        }
+        else {
+            children = Crossover(selections, locations, generator, popSize, currentPop, mutationChanceInt, options.mCrossover, &distances, options.mMutation);
+        }
+    }
+
+    // The memetic stage, if one is chosen.
+    ImproveChildren(children, distances, options, pool);
+    return children;
+}
+
+// This function runs the chosen local search on the shortest fraction of the children, in parallel, and returns the number
+// of improving moves it made. The budget of improving moves per generation is split between them so that the shares add up
+// to the budget. The local search uses no random numbers, so the result does not depend on the thread count.
+int ImproveChildren(Population& children, const DistanceStore& distances, const GAOptions& options, ThreadPool& pool) {
+    if (options.mLocalSearch == LocalSearchMode::None || children.mMembers.empty()) {
+        return 0;
+    }
+
+    // Pick the children that get improved: all of them, or the shortest ones.
+    std::vector<int> chosen(children.mMembers.size());
+    std::iota(chosen.begin(), chosen.end(), 0);
+    size_t count = std::min(chosen.size(), static_cast<size_t>(std::ceil(options.mLocalSearchFraction * chosen.size())));
+    // A budget smaller than that improves only as many children as it has moves.
+    int budget = options.mLocalSearchBudget;
+    if (budget > 0) {
+        count = std::min(count, static_cast<size_t>(budget));
+    }
+    if (count < chosen.size()) {
+        std::vector<double> lengths(children.mMembers.size());
+        for (size_t i = 0; i < lengths.size(); i++) {
+            lengths[i] = distances.TourLength(children.mMembers[i]);
+        }
+        std::nth_element(chosen.begin(), chosen.begin() + count, chosen.end(), [&lengths](int a, int b) {
+            return lengths[a] < lengths[b] || (lengths[a] == lengths[b] && a < b);
+        });
+        chosen.resize(count);
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    std::vector<int> moves(count, 0);
+    pool.ParallelFor(count, [&](size_t begin, size_t end, int) {
+        LocalSearchScratch scratch; // Scratch space shared by the children of this block.
+        for (size_t i = begin; i < end; i++) {
+            std::vector<int>& child = children.mMembers[chosen[i]];
+            // A budget that does not divide evenly gives the first children one more move each.
+            int maxMoves = budget <= 0 ? 0 : budget / static_cast<int>(count) + (static_cast<int>(i) < budget % static_cast<int>(count) ? 1 : 0);
+            if (options.mLocalSearch == LocalSearchMode::TwoOpt) {
+                moves[i] = TwoOpt(child, distances, maxMoves, scratch);
+            }
+            else if (options.mLocalSearch == LocalSearchMode::OrOpt) {
+                moves[i] = OrOpt(child, distances, maxMoves, scratch);
+            }
+            else if (options.mLocalSearch == LocalSearchMode::TwoOptOrOpt) {
+                moves[i] = TwoOptOrOpt(child, distances, maxMoves, scratch);
+            }
+            else {
+                moves[i] = LinKernighan(child, distances, maxMoves, scratch);
+            }
+        }
+    });
+    return std::accumulate(moves.begin(), moves.end(), 0);
+}
+
+// This function runs the Lin-Kernighan search to a local optimum on every tour, in parallel. It is the standalone solver
+// (on the whole initial population) and the polishing stage (on the best tour of the genetic algorithm).
+void PolishTours(Population& tours, const DistanceStore& distances, ThreadPool& pool) {
+    pool.ParallelFor(tours.mMembers.size(), [&](size_t begin, size_t end, int) {
+        LocalSearchScratch scratch; // Scratch space shared by the tours of this block.
+        for (size_t i = begin; i < end; i++) {
+            LinKernighan(tours.mMembers[i], distances, 0, scratch);
+        }
+    });
+}
+
+// Function that tells whether the chosen operators look up candidate neighbors, so they only get built when needed.
+bool NeedsCandidates(const GAOptions& options) {
+    return (options.mInitialTours != InitialTourMode::Shuffle && options.mInitialTours != InitialTourMode::Hilbert) || options.mSeeding != SeedingMode::Random || options.mCrossover == CrossoverMode::EdgeAssembly || options.mCrossover == CrossoverMode::EdgeAssemblyLocal || options.mCrossover == CrossoverMode::Greedy
+        || options.mLocalSearch != LocalSearchMode::None || options.mSolver != SolverMode::Genetic || options.mPolish;
+}
+
+// Instantiate the functions that take a generator for every engine the command line offers.
+#define INSTANTIATE_FOR_ENGINE(Engine) \
+    template Population FillInitialPopulation(int, Engine&, size_t); \
+    template Population FillInitialPopulation(int, Engine&, const std::vector<Location>&, const DistanceStore&, InitialTourMode); \
+    template void SeedInitialPopulation(Population&, Engine&, const DistanceStore&, SeedingMode, double); \
+    template std::vector<std::pair<int,int>> Select(std::vector<std::pair<int,double>>&, Engine&, int, RankingMode); \
+    template std::vector<std::pair<int,int>> SelectUniversal(std::vector<std::pair<int,double>>&, Engine&, int, RankingMode); \
+    template Population Crossover(const std::vector<std::pair<int,int>>&, const std::vector<Location>&, Engine&, int, const Population&, int, CrossoverMode, const DistanceStore*, MutationMode); \
+    template Population NextGeneration(std::vector<std::pair<int,double>>&, const Population&, const std::vector<Location>&, Engine&, int, int, int, int, const GAOptions&, const DistanceStore&, ThreadPool&, std::vector<std::pair<int,int>>&);
+
+INSTANTIATE_FOR_ENGINE(std::mt19937)
+INSTANTIATE_FOR_ENGINE(Xoshiro256StarStar)
+INSTANTIATE_FOR_ENGINE(Pcg64)
+#undef INSTANTIATE_FOR_ENGINE
+
 
 // functions that output the generations and solutions to the log file
 void OutputGeneration(std::string_view fileName, int genNumber, const Population& pop){
@@ -367,7 +850,7 @@ void OutputGeneration(std::string_view fileName, int genNumber, const Population
     }
 }
 
-void OutputSolution(std::string_view fileName, const std::vector<Location>& locations, const std::vector<int>& minDistanceVector, double minDistance) {
+void OutputSolution(std::string_view fileName, const std::vector<Location>& locations, const std::vector<int>& minDistanceVector, double minDistance, std::string_view unit) {
     std::ofstream out(fileName.data(), std::ios_base::app);
 
 
@@ -382,6 +865,9 @@ void OutputSolution(std::string_view fileName, const std::vector<Location>& loca
     }
 
     out << locations[0].mName << '\n';
-    out << "DISTANCE: " << minDistance << " miles";
+    out << "DISTANCE: " << minDistance;
+    if (!unit.empty()) {
+        out << ' ' << unit;
+    }
 
 }
\ No newline at end of file
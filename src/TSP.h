@@ -2,6 +2,9 @@
 #include <string>
 #include <vector>
 #include <random>
+#include <cstdint>
+#include "Parallel.h"
+#include "Rng.h"
 
 struct Location
 {
@@ -10,32 +13,190 @@ struct Location
 	double mLongitude = 0.0;
 };
 
+class DistanceStore;
+
 struct Population
 {
 	std::vector<std::vector<int>> mMembers;
 };
 
+// How Select ranks the fitnesses before weighting the top half of the population
+enum class RankingMode
+{
+	FullSort, // std::sort of every fitness (reproduces the sample output logs)
+	Partial,  // nth_element plus a top-2 pass, O(popSize)
+	Radix     // stable LSD radix sort on the bits of the fitnesses, O(popSize)
+};
+
+// How parents are selected for the next generation
+enum class SelectionMode
+{
+	Roulette,  // rank-weighted roulette wheel in Select (reproduces the sample output logs)
+	Universal, // the same weights, drawn by stochastic universal sampling in SelectUniversal
+	Tournament // k-tournament fused with crossover in TournamentCrossover
+};
+
+// Which permutation crossover operator builds the children
+enum class CrossoverMode
+{
+	Splice,            // prefix of one parent plus the rest in the other parent's order (reproduces the sample output logs)
+	Order,             // order crossover (OX1)
+	PartiallyMapped,   // partially mapped crossover (PMX)
+	EdgeAssembly,      // edge assembly crossover (EAX) with a random E-set
+	EdgeAssemblyLocal, // EAX with a single AB-cycle, a local change to one parent
+	Greedy             // greedy crossover: the nearer of the two parental successors at every step
+};
+
+// How a child is mutated when its mutation roll succeeds
+enum class MutationMode
+{
+	Swap,     // swap two random genes, which replaces up to four edges (reproduces the sample output logs)
+	Inversion // reverse the segment between two random positions, which replaces only the two edges at its ends
+};
+
+// How FillInitialPopulation builds the members of the initial population
+enum class InitialTourMode
+{
+	Shuffle,           // random permutations (reproduces the sample output logs)
+	Hilbert,           // the order along a Hilbert curve, then along randomly shifted and mirrored curves
+	CheapestInsertion, // the construction heuristics below give member 0 their plain tour and the others noisy ones
+	FarthestInsertion,
+	ConvexHull,
+	Christofides
+};
+
+// How part of the initial population is seeded with constructed tours (the rest stays random)
+enum class SeedingMode
+{
+	Random,          // every member is a random permutation (reproduces the sample output logs)
+	NearestNeighbor, // nearest-neighbor tours from random start cities
+	GreedyEdge       // greedy edge matching, with randomly perturbed edge lengths after the first member
+};
+
+// Which random number engine drives FillInitialPopulation, Select and Crossover
+enum class RngEngine
+{
+	Mt19937,  // std::mt19937 (reproduces the sample output logs)
+	Xoshiro,  // xoshiro256**, 32 bytes of state
+	Pcg64     // PCG XSL RR 128/64, 32 bytes of state
+};
+
+// Which local search improves the children after crossover (the memetic stage)
+enum class LocalSearchMode
+{
+	None,        // children are left as crossover and mutation made them (reproduces the sample output logs)
+	TwoOpt,      // 2-opt over candidate neighbors with don't-look bits
+	OrOpt,       // Or-opt moves of segments of 1 to 3 cities
+	TwoOptOrOpt, // both moves, sharing the don't-look bits
+	LinKernighan // Lin-Kernighan style variable-depth search with Or-opt
+};
+
+// Which edges make up the candidate lists
+enum class CandidateSet
+{
+	Nearest,         // the k nearest other locations
+	Delaunay,        // the Delaunay neighbors, topped up with the nearest locations
+	DelaunayQuadrant // the Delaunay neighbors and the nearest location in each quadrant, topped up the same way
+};
+
+// What ProcessCommandArgs runs
+enum class SolverMode
+{
+	Genetic,     // the genetic algorithm (reproduces the sample output logs)
+	LinKernighan, // Lin-Kernighan search from every member of the initial population, no generations
+	Clusters     // the genetic algorithm on every cluster of the locations, with the cluster tours joined and repaired
+};
+
+// Optional settings of the genetic algorithm, given on the command line as --name=value after the required arguments
+struct GAOptions
+{
+	RankingMode mRanking = RankingMode::FullSort;
+	SelectionMode mSelection = SelectionMode::Roulette;
+	CrossoverMode mCrossover = CrossoverMode::Splice;
+	MutationMode mMutation = MutationMode::Swap;
+	bool mAdaptiveMutation = false; // steer the mutation chance by the population's diversity every generation
+	int mMutationMin = 1; // bounds of the adaptive mutation chance, in percent
+	int mMutationMax = 90;
+	int mTournamentSize = 3;
+	int mCandidates = 10; // candidate neighbors per location for the operators that need them
+	CandidateSet mCandidateSet = CandidateSet::Nearest;
+	int mThreads = 0; // 0 means one thread per core
+	bool mParallelCrossover = false; // crossover on the thread pool with one counter-based stream per child
+	bool mParallelInit = false; // initial population on the thread pool with one counter-based stream per member
+	RngEngine mEngine = RngEngine::Mt19937;
+	LocalSearchMode mLocalSearch = LocalSearchMode::None;
+	double mLocalSearchFraction = 1.0; // fraction of the children, shortest first, that get the local search
+	int mLocalSearchBudget = 0; // improving moves per generation, shared by those children (0 means no limit)
+	InitialTourMode mInitialTours = InitialTourMode::Shuffle;
+	SeedingMode mSeeding = SeedingMode::Random;
+	double mSeedingFraction = 0.1; // fraction of the initial population that is seeded
+	SolverMode mSolver = SolverMode::Genetic;
+	int mClusterSize = 1000; // most cities per cluster of the cluster solver
+	bool mPolish = false; // Lin-Kernighan search on the best tour before it is written out
+};
+
+// The functions that take a generator are templates on the engine type. They are instantiated in TSP.cpp for
+// std::mt19937, Xoshiro256StarStar and Pcg64.
+
 std::vector<Location> ReadLocations(std::string_view inputFile);
 
-Population FillInitialPopulation (int popSize, std::mt19937& generator, size_t locationSize);
+// Same locations as ReadLocations, parsed and copied in chunks on the thread pool.
+std::vector<Location> ReadLocations(std::string_view inputFile, ThreadPool& pool);
+
+template <typename Engine>
+Population FillInitialPopulation (int popSize, Engine& generator, size_t locationSize);
+
+template <typename Engine>
+Population FillInitialPopulation(int popSize, Engine& generator, const std::vector<Location>& locations, const DistanceStore& distances, InitialTourMode mode);
 
-void OutputPopulationFile(std::string_view fileName, const Population& pop, std::string_view header);
+Population ParallelFillInitialPopulation(int popSize, uint64_t seed, const std::vector<Location>& locations, const DistanceStore& distances, InitialTourMode mode, ThreadPool& pool);
+
+template <typename Engine>
+void SeedInitialPopulation(Population& pop, Engine& generator, const DistanceStore& distances, SeedingMode seeding, double fraction);
+
+void OutputPopulationFile(std::string_view fileName, const Population& pop, std::string_view header, bool append = false);
 
 std::vector<std::pair<int,double>> computeFitnesses(const Population& population, const std::vector<Location>& locations);
 
+// Same fitnesses measured with the distance store, for instances whose distances are not the Haversine distance.
+std::vector<std::pair<int,double>> computeFitnesses(const Population& population, const DistanceStore& distances);
+
 double GetHaversineDistance(const double& lon1, const double& lat1, const double& lon2, const double& lat2);
 
 void OutputFitnessFile(std::string_view fileName, const std::vector<std::pair<int,double>>& fits);
 
-std::vector<std::pair<int,int>> Select(std::vector<std::pair<int,double>>& fitnesses, std::mt19937& generator, int popSize);
+std::vector<double> RankProbabilities(std::vector<std::pair<int,double>>& fitnesses, int popSize, RankingMode ranking);
+
+template <typename Engine>
+std::vector<std::pair<int,int>> Select(std::vector<std::pair<int,double>>& fitnesses, Engine& generator, int popSize, RankingMode ranking = RankingMode::FullSort);
+
+template <typename Engine>
+std::vector<std::pair<int,int>> SelectUniversal(std::vector<std::pair<int,double>>& fitnesses, Engine& generator, int popSize, RankingMode ranking = RankingMode::FullSort);
+
+void RankTopHalf(std::vector<std::pair<int,double>>& fitnesses, int topCount);
+
+void RadixSortFitnesses(std::vector<std::pair<int,double>>& fitnesses);
 
 std::vector<double> divEachBy(const std::vector<double>& v, double denominator);
 
 void OutputSelectedPairs(std::string_view fileName, const std::vector<std::pair<int,int>>& selections);
 
-Population Crossover(const std::vector<std::pair<int,int>>& selections, const std::vector<Location>& locations, std::mt19937& generator, int popSize, const Population& currentPop, int mutationChanceInt);
+template <typename Engine>
+Population Crossover(const std::vector<std::pair<int,int>>& selections, const std::vector<Location>& locations, Engine& generator, int popSize, const Population& currentPop, int mutationChanceInt, CrossoverMode crossover = CrossoverMode::Splice, const DistanceStore* distances = nullptr, MutationMode mutation = MutationMode::Swap);
+
+Population ParallelCrossover(const std::vector<std::pair<int,int>>& selections, uint64_t seed, int genNumber, int popSize, const Population& currentPop, int mutationChanceInt, CrossoverMode crossover, const DistanceStore* distances, ThreadPool& pool, MutationMode mutation = MutationMode::Swap);
+
+Population TournamentCrossover(const std::vector<std::pair<int,double>>& fitnesses, uint64_t seed, int genNumber, int tournamentSize, int popSize, const Population& currentPop, int mutationChanceInt, CrossoverMode crossover, const DistanceStore* distances, ThreadPool& pool, std::vector<std::pair<int,int>>& selections, MutationMode mutation = MutationMode::Swap);
+
+template <typename Engine>
+Population NextGeneration(std::vector<std::pair<int,double>>& fitnesses, const Population& currentPop, const std::vector<Location>& locations, Engine& generator, int seed, int genNumber, int popSize, int mutationChanceInt, const GAOptions& options, const DistanceStore& distances, ThreadPool& pool, std::vector<std::pair<int,int>>& selections);
+
+int ImproveChildren(Population& children, const DistanceStore& distances, const GAOptions& options, ThreadPool& pool);
+
+void PolishTours(Population& tours, const DistanceStore& distances, ThreadPool& pool);
 
+bool NeedsCandidates(const GAOptions& options);
 
 void OutputGeneration(std::string_view fileName, int genNumber, const Population& pop);
 
-void OutputSolution(std::string_view fileName, const std::vector<Location>& locations, const std::vector<int>& minDistanceVector, double minDistance);
\ No newline at end of file
+void OutputSolution(std::string_view fileName, const std::vector<Location>& locations, const std::vector<int>& minDistanceVector, double minDistance, std::string_view unit = "miles");
\ No newline at end of file
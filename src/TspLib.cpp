@@ -0,0 +1,230 @@
+#include "TspLib.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include "LocationFile.h"
+
+namespace
+{
+    // Reads a TSPLIB file line by line for the header and token by token for the sections, which may wrap their
+    // numbers over lines in any way.
+    struct TspLibReader
+    {
+        const char* mPosition = nullptr;
+        const char* mEnd = nullptr;
+
+        bool AtEnd() const { return mPosition >= mEnd; }
+
+        // Function that returns the next line without its line ending.
+        std::string_view NextLine() {
+            const char* newline = static_cast<const char*>(std::memchr(mPosition, '\n', mEnd - mPosition));
+            const char* lineEnd = newline ? newline : mEnd;
+            std::string_view line(mPosition, lineEnd - mPosition);
+            mPosition = newline ? newline + 1 : mEnd;
+            return line;
+        }
+
+        // Function that returns the next number, wherever it is, and throws when the file ends or holds something else.
+        double NextNumber(const char* section) {
+            while (mPosition < mEnd && std::strchr(" \t\r\n", *mPosition)) {
+                mPosition++;
+            }
+            double value = 0.0;
+            std::from_chars_result result = std::from_chars(mPosition, mEnd, value);
+            if (mPosition == mEnd || result.ec != std::errc()) {
+                throw std::invalid_argument(std::string("TSPLIB ") + section + " ends early or holds something else than numbers");
+            }
+            mPosition = result.ptr;
+            return value;
+        }
+    };
+
+    std::string_view Trim(std::string_view text) {
+        while (!text.empty() && std::strchr(" \t\r", text.front())) {
+            text.remove_prefix(1);
+        }
+        while (!text.empty() && std::strchr(" \t\r", text.back())) {
+            text.remove_suffix(1);
+        }
+        return text;
+    }
+
+    // Function that reads dimension lines of "node x y" into coordinates, placed by node number.
+    void ReadNodeCoordinates(TspLibReader& reader, size_t dimension, const char* section, std::vector<ProjectedPoint>& coordinates) {
+        coordinates.assign(dimension, ProjectedPoint());
+        std::vector<char> seen(dimension, 0);
+        for (size_t i = 0; i < dimension; i++) {
+            double node = reader.NextNumber(section);
+            if (node < 1 || node > static_cast<double>(dimension) || seen[static_cast<size_t>(node) - 1]) {
+                throw std::invalid_argument(std::string("TSPLIB ") + section + " has a bad or repeated node number");
+            }
+            seen[static_cast<size_t>(node) - 1] = 1;
+            coordinates[static_cast<size_t>(node) - 1].mX = reader.NextNumber(section);
+            coordinates[static_cast<size_t>(node) - 1].mY = reader.NextNumber(section);
+        }
+    }
+
+    // Function that reads the EDGE_WEIGHT_SECTION in the given format into the full symmetric matrix.
+    void ReadEdgeWeights(TspLibReader& reader, size_t dimension, std::string_view format, std::vector<double>& matrix) {
+        const char* section = "EDGE_WEIGHT_SECTION";
+        matrix.assign(dimension * dimension, 0.0);
+        if (format == "FULL_MATRIX") {
+            for (size_t i = 0; i < dimension * dimension; i++) {
+                matrix[i] = reader.NextNumber(section);
+            }
+            return;
+        }
+
+        // The triangles list row by row the entries of row i from column first(i) to column last(i).
+        bool upper = format == "UPPER_ROW" || format == "UPPER_DIAG_ROW";
+        bool diagonal = format == "UPPER_DIAG_ROW" || format == "LOWER_DIAG_ROW";
+        if (!upper && format != "LOWER_ROW" && format != "LOWER_DIAG_ROW") {
+            throw std::invalid_argument("Unsupported TSPLIB EDGE_WEIGHT_FORMAT: " + std::string(format));
+        }
+        for (size_t i = 0; i < dimension; i++) {
+            size_t first = upper ? (diagonal ? i : i + 1) : 0;
+            size_t last = upper ? dimension : (diagonal ? i + 1 : i);
+            for (size_t j = first; j < last; j++) {
+                double weight = reader.NextNumber(section);
+                matrix[i * dimension + j] = weight;
+                matrix[j * dimension + i] = weight;
+            }
+        }
+        for (size_t i = 0; i < dimension; i++) {
+            matrix[i * dimension + i] = 0.0;
+        }
+    }
+}
+
+bool IsTspLibFile(std::string_view fileName) {
+    return fileName.size() >= 4 && fileName.substr(fileName.size() - 4) == ".tsp";
+}
+
+TspLibInstance ReadTspLib(std::string_view fileName) {
+    MappedFile file(fileName);
+    if (!file.IsOpen()) {
+        throw std::invalid_argument("Cannot open " + std::string(fileName));
+    }
+    TspLibReader reader;
+    reader.mPosition = file.Text().data();
+    reader.mEnd = file.Text().data() + file.Text().size();
+
+    TspLibInstance instance;
+    size_t dimension = 0;
+    std::string weightType;
+    std::string weightFormat;
+    std::vector<ProjectedPoint> display;
+    bool hasCoordinates = false;
+    bool hasWeights = false;
+    while (!reader.AtEnd()) {
+        std::string_view line = Trim(reader.NextLine());
+        size_t colon = line.find(':');
+        std::string_view key = Trim(line.substr(0, colon));
+        std::string_view value = colon == std::string_view::npos ? std::string_view() : Trim(line.substr(colon + 1));
+
+        if (key.empty() || key == "COMMENT" || key == "DISPLAY_DATA_TYPE" || key == "NODE_COORD_TYPE") {
+            continue;
+        }
+        else if (key == "EOF") {
+            break;
+        }
+        else if (key == "NAME") {
+            instance.mName = value;
+        }
+        else if (key == "TYPE") {
+            if (value != "TSP") {
+                throw std::invalid_argument("Unsupported TSPLIB TYPE: " + std::string(value));
+            }
+        }
+        else if (key == "DIMENSION") {
+            dimension = static_cast<size_t>(std::stoul(std::string(value)));
+        }
+        else if (key == "EDGE_WEIGHT_TYPE") {
+            weightType = value;
+        }
+        else if (key == "EDGE_WEIGHT_FORMAT") {
+            weightFormat = value;
+        }
+        else if (key == "NODE_COORD_SECTION") {
+            ReadNodeCoordinates(reader, dimension, "NODE_COORD_SECTION", instance.mCoordinates);
+            hasCoordinates = true;
+        }
+        else if (key == "DISPLAY_DATA_SECTION") {
+            ReadNodeCoordinates(reader, dimension, "DISPLAY_DATA_SECTION", display);
+        }
+        else if (key == "EDGE_WEIGHT_SECTION") {
+            ReadEdgeWeights(reader, dimension, weightFormat, instance.mMatrix);
+            hasWeights = true;
+        }
+        else {
+            throw std::invalid_argument("Unsupported TSPLIB entry: " + std::string(key));
+        }
+    }
+
+    if (dimension == 0) {
+        throw std::invalid_argument("TSPLIB file without DIMENSION");
+    }
+    if (weightType == "EUC_2D") {
+        instance.mMetric = DistanceMetric::Euclidean;
+    }
+    else if (weightType == "GEO") {
+        instance.mMetric = DistanceMetric::Geographic;
+    }
+    else if (weightType == "ATT") {
+        instance.mMetric = DistanceMetric::Att;
+    }
+    else if (weightType == "EXPLICIT") {
+        instance.mMetric = DistanceMetric::Explicit;
+    }
+    else {
+        throw std::invalid_argument("Unsupported TSPLIB EDGE_WEIGHT_TYPE: " + weightType);
+    }
+    if (instance.mMetric == DistanceMetric::Explicit ? !hasWeights : !hasCoordinates) {
+        throw std::invalid_argument("TSPLIB file without the section its EDGE_WEIGHT_TYPE needs");
+    }
+
+    // Place the locations: GEO coordinates are degrees and minutes, the planar ones are scaled into a small square at
+    // the equator, where the KD-tree's great-circle neighbors are the planar ones.
+    instance.mLocations.resize(dimension);
+    const std::vector<ProjectedPoint>& points = instance.mMetric == DistanceMetric::Explicit ? display : instance.mCoordinates;
+    instance.mHasGeometry = !points.empty();
+    double minX = 0.0, minY = 0.0, extent = 0.0;
+    if (!points.empty()) {
+        auto [lowX, highX] = std::minmax_element(points.begin(), points.end(), [](const ProjectedPoint& a, const ProjectedPoint& b) { return a.mX < b.mX; });
+        auto [lowY, highY] = std::minmax_element(points.begin(), points.end(), [](const ProjectedPoint& a, const ProjectedPoint& b) { return a.mY < b.mY; });
+        minX = lowX->mX;
+        minY = lowY->mY;
+        extent = std::max(highX->mX - minX, highY->mY - minY);
+    }
+    for (size_t i = 0; i < dimension; i++) {
+        Location& location = instance.mLocations[i];
+        location.mName = std::to_string(i + 1);
+        if (points.empty()) {
+            continue;
+        }
+        if (instance.mMetric == DistanceMetric::Geographic) {
+            auto degrees = [](double value) {
+                int whole = static_cast<int>(value);
+                return whole + (value - whole) * 100.0 / 60.0;
+            };
+            location.mLatitude = degrees(points[i].mX);
+            location.mLongitude = degrees(points[i].mY);
+        }
+        else if (extent > 0.0) {
+            location.mLatitude = (points[i].mY - minY) / extent - 0.5;
+            location.mLongitude = (points[i].mX - minX) / extent - 0.5;
+        }
+    }
+    return instance;
+}
+
+DistanceStore MakeDistanceStore(TspLibInstance& instance) {
+    if (instance.mMetric == DistanceMetric::Haversine) {
+        return DistanceStore(instance.mLocations);
+    }
+    if (instance.mMetric == DistanceMetric::Explicit) {
+        return DistanceStore(instance.mLocations, std::move(instance.mMatrix));
+    }
+    return DistanceStore(instance.mLocations, instance.mMetric, instance.mCoordinates);
+}
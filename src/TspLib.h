@@ -0,0 +1,36 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Distance.h"
+#include "TSP.h"
+
+// Reading of TSPLIB .tsp files, for benchmarks against published optima. Supported are symmetric TSP instances with
+// NODE_COORD_SECTION and EUC_2D, GEO or ATT distances, and EXPLICIT instances whose EDGE_WEIGHT_SECTION is a
+// FULL_MATRIX or an UPPER_ROW, LOWER_ROW, UPPER_DIAG_ROW or LOWER_DIAG_ROW triangle. The locations are named after the
+// node numbers. Their latitude and longitude place the points for the KD-tree and the projections: GEO coordinates
+// become degrees, EUC_2D and ATT coordinates are scaled into a one-degree square at the equator, and an explicit
+// instance uses its DISPLAY_DATA_SECTION if it has one (all its locations are at 0, 0 otherwise, so nothing that works
+// on the placement, like the Hilbert curve or the insertion heuristics that look at the points, can run on it).
+
+// A TSPLIB instance as read from the file
+struct TspLibInstance
+{
+	std::string mName;
+	std::vector<Location> mLocations;
+	DistanceMetric mMetric = DistanceMetric::Haversine;
+	std::vector<ProjectedPoint> mCoordinates; // x and y as in the file, for the coordinate metrics
+	std::vector<double> mMatrix; // the full matrix, for explicit instances
+	bool mHasGeometry = true; // false for an explicit instance without DISPLAY_DATA_SECTION, whose locations are all at 0, 0
+};
+
+// Function that tells whether a file name has the TSPLIB .tsp extension.
+bool IsTspLibFile(std::string_view fileName);
+
+// Function that reads a TSPLIB file. Throws std::invalid_argument on a file that cannot be opened, an unsupported type,
+// distance function or section, or a section that ends early.
+TspLibInstance ReadTspLib(std::string_view fileName);
+
+// Function that builds the distance store of an instance: the Haversine store for plain locations, the TSPLIB distance
+// function on the coordinates, or the explicit matrix, which is moved out of the instance into the store.
+DistanceStore MakeDistanceStore(TspLibInstance& instance);
@@ -0,0 +1,297 @@
+#include "TwoLevelTour.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+void TwoLevelTour::Assign(const std::vector<int>& tour) {
+    int size = static_cast<int>(tour.size());
+    mNodes.resize(size);
+
+    // Segments of about sqrt(N) cities, but at least three of them so that a reversed path never wraps onto itself.
+    mGroupSize = std::max(1, static_cast<int>(std::sqrt(static_cast<double>(size))));
+    while (mGroupSize > 1 && (size + mGroupSize - 1) / mGroupSize < 3) {
+        --mGroupSize;
+    }
+    int count = size == 0 ? 0 : (size + mGroupSize - 1) / mGroupSize;
+    mSegments.resize(count);
+    for (int s = 0; s < count; s++) {
+        int begin = s * mGroupSize;
+        int end = std::min(size, begin + mGroupSize);
+        Segment& segment = mSegments[s];
+        segment.mFirst = tour[begin];
+        segment.mLast = tour[end - 1];
+        segment.mNext = s + 1 == count ? 0 : s + 1;
+        segment.mPrev = s == 0 ? count - 1 : s - 1;
+        segment.mRank = s;
+        segment.mSize = end - begin;
+        segment.mReversed = false;
+        for (int i = begin; i < end; i++) {
+            Node& node = mNodes[tour[i]];
+            node.mNext = i + 1 < end ? tour[i + 1] : -1;
+            node.mPrev = i > begin ? tour[i - 1] : -1;
+            node.mSegment = s;
+            node.mRank = i - begin;
+        }
+    }
+    mUnbalanced = false;
+}
+
+void TwoLevelTour::ToVector(std::vector<int>& tour) const {
+    tour.resize(mNodes.size());
+    int city = 0;
+    for (size_t i = 0; i < tour.size(); i++) {
+        tour[i] = city;
+        city = Next(city);
+    }
+}
+
+bool TwoLevelTour::Between(int a, int b, int c) const {
+    long long keyA = Key(a);
+    long long keyB = Key(b);
+    long long keyC = Key(c);
+    if (keyA <= keyC) {
+        return keyA <= keyB && keyB <= keyC;
+    }
+    // The path from a to c wraps around the segment with rank 0.
+    return keyB >= keyA || keyB <= keyC;
+}
+
+void TwoLevelTour::Reverse(int from, int to) {
+    // Tours of one or two cities read the same in both directions.
+    if (from == to || mSegments.size() < 3) {
+        return;
+    }
+    if (mUnbalanced) {
+        Rebuild();
+    }
+
+    int first = mNodes[from].mSegment;
+    int last = mNodes[to].mSegment;
+    if (first == last) {
+        if (Key(from) <= Key(to)) {
+            ReverseInside(first, from, to);
+        }
+        else if (Next(to) != from) {
+            // The path leaves the segment and goes around the whole tour, so reverse the cities in between instead.
+            ReverseInside(first, Next(to), Prev(from));
+        }
+        return;
+    }
+
+    // The other side spans count - span + 2 segments at most; reverse it when that is fewer.
+    int count = static_cast<int>(mSegments.size());
+    int span = (mSegments[last].mRank - mSegments[first].mRank + count) % count + 1;
+    if (2 * span > count + 2) {
+        int after = Next(to);
+        if (after == from) {
+            return;
+        }
+        int before = Prev(from);
+        from = after;
+        to = before;
+        first = mNodes[from].mSegment;
+        last = mNodes[to].mSegment;
+        if (first == last) {
+            ReverseInside(first, from, to);
+            return;
+        }
+    }
+
+    // Split the end segments so the path covers whole segments. The smaller part of a split segment joins its neighbor.
+    SplitBefore(from);
+    first = mNodes[from].mSegment;
+    last = mNodes[to].mSegment;
+    if (first == last) {
+        ReverseInside(first, from, to);
+        return;
+    }
+    SplitAfter(to);
+    ReverseSegments(mNodes[from].mSegment, mNodes[to].mSegment);
+}
+
+// Function that reverses the path from..to, which lies inside one segment, by relinking its cities: O(segment size).
+void TwoLevelTour::ReverseInside(int segment, int from, int to) {
+    Segment& current = mSegments[segment];
+    // The same path in the segment's own order
+    int x = current.mReversed ? to : from;
+    int y = current.mReversed ? from : to;
+    int before = x == current.mFirst ? -1 : mNodes[x].mPrev;
+    int after = y == current.mLast ? -1 : mNodes[y].mNext;
+    int rankSum = mNodes[x].mRank + mNodes[y].mRank;
+
+    int city = x;
+    while (true) {
+        Node& node = mNodes[city];
+        int next = node.mNext;
+        std::swap(node.mNext, node.mPrev);
+        node.mRank = rankSum - node.mRank;
+        if (city == y) {
+            break;
+        }
+        city = next;
+    }
+
+    mNodes[y].mPrev = before;
+    if (before < 0) {
+        current.mFirst = y;
+    }
+    else {
+        mNodes[before].mNext = y;
+    }
+    mNodes[x].mNext = after;
+    if (after < 0) {
+        current.mLast = x;
+    }
+    else {
+        mNodes[after].mPrev = x;
+    }
+}
+
+// Function that reverses the run of whole segments first..last (in tour order): each one flips its reversed bit and the
+// run is relinked in the opposite order. O(number of segments).
+void TwoLevelTour::ReverseSegments(int first, int last) {
+    int count = static_cast<int>(mSegments.size());
+    int before = mSegments[first].mPrev;
+    int after = mSegments[last].mNext;
+    // The run keeps the ranks it had, handed out again from its new first segment.
+    int rank = mSegments[first].mRank;
+    int segment = last;
+    while (true) {
+        Segment& current = mSegments[segment];
+        int prev = current.mPrev;
+        current.mReversed = !current.mReversed;
+        std::swap(current.mNext, current.mPrev);
+        current.mRank = rank;
+        rank = rank + 1 == count ? 0 : rank + 1;
+        if (segment == first) {
+            break;
+        }
+        segment = prev;
+    }
+    mSegments[last].mPrev = before;
+    mSegments[before].mNext = last;
+    mSegments[first].mNext = after;
+    mSegments[after].mPrev = first;
+}
+
+// Function that makes city the first city of its segment in tour order.
+void TwoLevelTour::SplitBefore(int city) {
+    const Node& node = mNodes[city];
+    const Segment& segment = mSegments[node.mSegment];
+    int index = segment.mReversed ? mNodes[segment.mLast].mRank - node.mRank : node.mRank - mNodes[segment.mFirst].mRank;
+    if (index == 0) {
+        return;
+    }
+    if (index <= segment.mSize - index) {
+        MoveHeadToPrevious(node.mSegment, index);
+    }
+    else {
+        MoveTailToNext(node.mSegment, segment.mSize - index);
+    }
+}
+
+// Function that makes city the last city of its segment in tour order.
+void TwoLevelTour::SplitAfter(int city) {
+    const Node& node = mNodes[city];
+    const Segment& segment = mSegments[node.mSegment];
+    int index = segment.mReversed ? mNodes[segment.mLast].mRank - node.mRank : node.mRank - mNodes[segment.mFirst].mRank;
+    int tail = segment.mSize - index - 1;
+    if (tail == 0) {
+        return;
+    }
+    if (tail <= index + 1) {
+        MoveTailToNext(node.mSegment, tail);
+    }
+    else {
+        MoveHeadToPrevious(node.mSegment, index + 1);
+    }
+}
+
+// Function that moves the first count cities (tour order) of a segment to the end of the segment before it.
+void TwoLevelTour::MoveHeadToPrevious(int segment, int count) {
+    Segment& current = mSegments[segment];
+    int city = FirstOf(current);
+    for (int k = 0; k < count; k++) {
+        int next = current.mReversed ? mNodes[city].mPrev : mNodes[city].mNext;
+        AppendToTourEnd(current.mPrev, city);
+        city = next;
+    }
+    if (current.mReversed) {
+        current.mLast = city;
+    }
+    else {
+        current.mFirst = city;
+    }
+    current.mSize -= count;
+}
+
+// Function that moves the last count cities (tour order) of a segment to the start of the segment after it.
+void TwoLevelTour::MoveTailToNext(int segment, int count) {
+    Segment& current = mSegments[segment];
+    int city = LastOf(current);
+    for (int k = 0; k < count; k++) {
+        int prev = current.mReversed ? mNodes[city].mNext : mNodes[city].mPrev;
+        PrependToTourStart(current.mNext, city);
+        city = prev;
+    }
+    if (current.mReversed) {
+        current.mFirst = city;
+    }
+    else {
+        current.mLast = city;
+    }
+    current.mSize -= count;
+}
+
+void TwoLevelTour::AppendToTourEnd(int segment, int city) {
+    Segment& target = mSegments[segment];
+    Node& node = mNodes[city];
+    if (target.mReversed) {
+        Node& end = mNodes[target.mFirst];
+        end.mPrev = city;
+        node.mNext = target.mFirst;
+        node.mRank = end.mRank - 1;
+        target.mFirst = city;
+    }
+    else {
+        Node& end = mNodes[target.mLast];
+        end.mNext = city;
+        node.mPrev = target.mLast;
+        node.mRank = end.mRank + 1;
+        target.mLast = city;
+    }
+    node.mSegment = segment;
+    // Segments that grew far past sqrt(N) make reversals slow; the next Reverse splits the tour evenly again.
+    if (++target.mSize > 4 * mGroupSize) {
+        mUnbalanced = true;
+    }
+}
+
+void TwoLevelTour::PrependToTourStart(int segment, int city) {
+    Segment& target = mSegments[segment];
+    Node& node = mNodes[city];
+    if (target.mReversed) {
+        Node& end = mNodes[target.mLast];
+        end.mNext = city;
+        node.mPrev = target.mLast;
+        node.mRank = end.mRank + 1;
+        target.mLast = city;
+    }
+    else {
+        Node& end = mNodes[target.mFirst];
+        end.mPrev = city;
+        node.mNext = target.mFirst;
+        node.mRank = end.mRank - 1;
+        target.mFirst = city;
+    }
+    node.mSegment = segment;
+    if (++target.mSize > 4 * mGroupSize) {
+        mUnbalanced = true;
+    }
+}
+
+// Function that lays the tour out again in equal segments, in O(N).
+void TwoLevelTour::Rebuild() {
+    ToVector(mOrder);
+    Assign(mOrder);
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <vector>
+
+// A tour stored as a two-level doubly-linked list (Fredman, Johnson, McGeoch and Ostheimer). The cities are split into
+// about sqrt(N) segments; each segment is a doubly-linked list with a reversed bit, and the segments form a doubly-linked
+// list of their own. Next, Prev and Between take O(1), and reversing a path takes O(sqrt(N)): the path's end segments are
+// split so it covers whole segments, whose reversed bits are flipped and whose order is reversed. A flat vector reverses
+// in O(N), which dominates local search on big tours.
+class TwoLevelTour
+{
+public:
+	// Builds the list from a permutation of 0..N-1 (the tour order). Reuses the buffers of an earlier tour.
+	void Assign(const std::vector<int>& tour);
+
+	// Writes the tour into a flat permutation that starts at location 0.
+	void ToVector(std::vector<int>& tour) const;
+
+	int Size() const { return static_cast<int>(mNodes.size()); }
+
+	// The city after (before) city in tour order
+	int Next(int city) const
+	{
+		const Node& node = mNodes[city];
+		const Segment& segment = mSegments[node.mSegment];
+		if (city == LastOf(segment))
+		{
+			return FirstOf(mSegments[segment.mNext]);
+		}
+		return segment.mReversed ? node.mPrev : node.mNext;
+	}
+
+	int Prev(int city) const
+	{
+		const Node& node = mNodes[city];
+		const Segment& segment = mSegments[node.mSegment];
+		if (city == FirstOf(segment))
+		{
+			return LastOf(mSegments[segment.mPrev]);
+		}
+		return segment.mReversed ? node.mNext : node.mPrev;
+	}
+
+	// Whether b is on the path from a to c in tour order (a and c included)
+	bool Between(int a, int b, int c) const;
+
+	// Reverses the path from city from to city to (following Next). Reversing either side of a cycle gives the same cycle,
+	// so the side that spans fewer segments is reversed.
+	void Reverse(int from, int to);
+
+private:
+	struct Node
+	{
+		int mNext; // neighbors inside the segment, in the segment's own order
+		int mPrev;
+		int mSegment;
+		int mRank; // consecutive along the segment's own order
+	};
+
+	struct Segment
+	{
+		int mFirst; // ends in the segment's own order (the tour order unless reversed)
+		int mLast;
+		int mNext; // neighboring segments in tour order
+		int mPrev;
+		int mRank; // 0..S-1 along the tour, wrapping around once
+		int mSize;
+		bool mReversed;
+	};
+
+	int FirstOf(const Segment& segment) const { return segment.mReversed ? segment.mLast : segment.mFirst; }
+	int LastOf(const Segment& segment) const { return segment.mReversed ? segment.mFirst : segment.mLast; }
+
+	// Position of a city for Between: its segment's rank, then its place inside the segment in tour order.
+	long long Key(int city) const
+	{
+		const Node& node = mNodes[city];
+		const Segment& segment = mSegments[node.mSegment];
+		return static_cast<long long>(segment.mRank) * (2LL << 31) + (segment.mReversed ? -node.mRank : node.mRank);
+	}
+
+	void ReverseInside(int segment, int from, int to);
+	void ReverseSegments(int first, int last);
+	void SplitBefore(int city);
+	void SplitAfter(int city);
+	void MoveHeadToPrevious(int segment, int city);
+	void MoveTailToNext(int segment, int city);
+	void AppendToTourEnd(int segment, int city);
+	void PrependToTourStart(int segment, int city);
+	void Rebuild();
+
+	std::vector<Node> mNodes;
+	std::vector<Segment> mSegments;
+	std::vector<int> mOrder;
+	int mGroupSize = 1;
+	bool mUnbalanced = false;
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+// A set of city indices for building tours. Clearing it is O(1): every Clear starts a new stamp, and a city
+// is in the set only if it carries the current stamp. Keep one per thread and reuse it for every child.
+class VisitedSet
+{
+public:
+	// Empties the set and makes room for cities 0..size-1.
+	void Clear(size_t size)
+	{
+		if (mStamps.size() < size)
+		{
+			mStamps.resize(size, 0);
+		}
+		// When the stamp wraps around, old stamps could look current again, so wipe them.
+		if (++mStamp == 0)
+		{
+			std::fill(mStamps.begin(), mStamps.end(), 0);
+			mStamp = 1;
+		}
+	}
+
+	bool Contains(int city) const { return mStamps[city] == mStamp; }
+
+	void Insert(int city) { mStamps[city] = mStamp; }
+
+private:
+	std::vector<uint32_t> mStamps;
+	uint32_t mStamp = 0;
+};
@@ -1,7 +1,23 @@
 #include "catch.hpp"
 #include "SrcMain.h"
 #include "TSP.h"
+#include "Operators.h"
+#include "Distance.h"
+#include "LocalSearch.h"
+#include "Diversity.h"
+#include "Construction.h"
+#include "KdTree.h"
+#include "Delaunay.h"
+#include "Clusters.h"
+#include "LocationFile.h"
+#include "TspLib.h"
 #include <string>
+#include <fstream>
+#include <cstdio>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <numeric>
 
 // Don't change this
 #ifdef _MSC_VER
@@ -16,6 +32,30 @@ extern bool CheckFileMD5(const std::string& fileName, const std::string& expecte
 extern bool CheckTextFilesSame(const std::string& fileNameA, 
 	const std::string& fileNameB);
 
+// Helper that draws size random locations in the one-degree square north-east of 34, -118
+static std::vector<Location> RandomLocations(size_t size, std::mt19937& generator)
+{
+	std::uniform_real_distribution<double> coordinate(0.0, 1.0);
+	std::vector<Location> locations(size);
+	for (auto& location : locations)
+	{
+		location.mLatitude = 34.0 + coordinate(generator);
+		location.mLongitude = -118.0 + coordinate(generator);
+	}
+	return locations;
+}
+
+// Helper that requires the tour to visit every location from 0 to its size - 1 exactly once
+static void RequirePermutation(const std::vector<int>& tour)
+{
+	std::vector<int> sorted = tour;
+	std::sort(sorted.begin(), sorted.end());
+	for (size_t i = 0; i < sorted.size(); i++)
+	{
+		REQUIRE(sorted[i] == static_cast<int>(i));
+	}
+}
+
 // Provided Complete file test cases
 // (Once you pass the first section, comment out the other)
 TEST_CASE("Full file test cases", "[student]")
@@ -105,3 +145,1283 @@ TEST_CASE("Full file test cases", "[student]")
 		REQUIRE(result);
 	}
 }
+
+TEST_CASE("Fitness ranking", "[student]")
+{
+	std::mt19937 generator(1337);
+	std::uniform_real_distribution<double> dist(0.0, 500.0);
+	std::vector<std::pair<int,double>> fitnesses;
+	for (int i = 0; i < 1000; i++)
+	{
+		// Round some of the values so there are ties
+		double fit = dist(generator);
+		fitnesses.emplace_back(i, i % 3 == 0 ? std::round(fit) : fit);
+	}
+	std::vector<std::pair<int,double>> expected = fitnesses;
+	std::stable_sort(expected.begin(), expected.end(), [](const std::pair<int,double>& a, const std::pair<int,double>& b) {
+		return a.second < b.second;
+	});
+
+	SECTION("RadixSortFitnesses matches a stable sort")
+	{
+		std::vector<std::pair<int,double>> sorted = fitnesses;
+		RadixSortFitnesses(sorted);
+		REQUIRE(sorted == expected);
+	}
+	SECTION("Radix ranking gives the weights of the stable order")
+	{
+		std::vector<std::pair<int,double>> sorted = expected;
+		std::vector<std::pair<int,double>> ranked = fitnesses;
+		REQUIRE(RankProbabilities(ranked, 1000, RankingMode::Radix) == RankProbabilities(sorted, 1000, RankingMode::FullSort));
+	}
+	SECTION("RankTopHalf finds ranks 0 and 1 and the top half")
+	{
+		std::vector<std::pair<int,double>> ranked = fitnesses;
+		RankTopHalf(ranked, 500);
+		REQUIRE(ranked[0].second == expected[0].second);
+		REQUIRE(ranked[1].second == expected[1].second);
+		double worstTop = std::max_element(ranked.begin(), ranked.begin() + 500, [](const std::pair<int,double>& a, const std::pair<int,double>& b) {
+			return a.second < b.second;
+		})->second;
+		REQUIRE(worstTop <= expected[500].second);
+	}
+}
+
+TEST_CASE("Tournament selection and crossover", "[student]")
+{
+	std::mt19937 generator(1337);
+	Population pop = FillInitialPopulation(64, generator, 20);
+	std::vector<std::pair<int,double>> fitnesses;
+	for (int i = 0; i < 64; i++)
+	{
+		fitnesses.emplace_back(i, static_cast<double>((i * 37) % 64));
+	}
+
+	ThreadPool pool(3);
+	std::vector<std::pair<int,int>> selections;
+	Population next = TournamentCrossover(fitnesses, 1337, 1, 3, 64, pop, 50, CrossoverMode::Splice, nullptr, pool, selections);
+	REQUIRE(next.mMembers.size() == 64);
+	REQUIRE(selections.size() == 64);
+	for (const auto& member : next.mMembers)
+	{
+		RequirePermutation(member);
+		REQUIRE(member[0] == 0);
+	}
+
+	// The same seed and generation reproduce the same children, whatever the thread count
+	ThreadPool single(1);
+	std::vector<std::pair<int,int>> again;
+	REQUIRE(TournamentCrossover(fitnesses, 1337, 1, 3, 64, pop, 50, CrossoverMode::Splice, nullptr, single, again).mMembers == next.mMembers);
+	REQUIRE(again == selections);
+}
+
+TEST_CASE("Parallel crossover", "[student]")
+{
+	// Philox4x32-10 known answer (Random123 test vector for a zero key and counter)
+	Philox4x32 philox(0, 0, 0);
+	REQUIRE(philox() == 0x6627e8d5u);
+	REQUIRE(philox() == 0xe169c58du);
+	REQUIRE(philox() == 0xbc57ac4cu);
+	REQUIRE(philox() == 0x9b00dbd8u);
+
+	std::mt19937 generator(2024);
+	Population pop = FillInitialPopulation(50, generator, 30);
+	std::vector<std::pair<int,int>> selections;
+	for (int i = 0; i < 50; i++)
+	{
+		selections.emplace_back(i, (i * 7 + 3) % 50);
+	}
+
+	ThreadPool single(1);
+	ThreadPool several(4);
+	Population first = ParallelCrossover(selections, 2024, 5, 50, pop, 40, CrossoverMode::Order, nullptr, single);
+	Population second = ParallelCrossover(selections, 2024, 5, 50, pop, 40, CrossoverMode::Order, nullptr, several);
+	REQUIRE(first.mMembers == second.mMembers);
+	REQUIRE(first.mMembers.size() == 50);
+	REQUIRE(first.mMembers[0][0] == 0);
+
+	// Another generation gives different streams
+	REQUIRE(ParallelCrossover(selections, 2024, 6, 50, pop, 40, CrossoverMode::Order, nullptr, several).mMembers != first.mMembers);
+}
+
+TEST_CASE("Random engines", "[student]")
+{
+	// PCG64 known answer (the pcg64 demo of the reference implementation, seeded with 42 and stream 54)
+	Pcg64 pcg(42, 54);
+	REQUIRE(pcg() == 0x86b1da1d72062b68ull);
+	REQUIRE(pcg() == 0x1304aa46c9853d39ull);
+	REQUIRE(pcg() == 0xa3670e9e0dd50358ull);
+
+	// The genetic algorithm runs the same way with any engine
+	Xoshiro256StarStar generator(1337);
+	Population pop = FillInitialPopulation(16, generator, 12);
+	std::vector<std::pair<int,double>> fitnesses;
+	for (int i = 0; i < 16; i++)
+	{
+		REQUIRE(pop.mMembers[i][0] == 0);
+		fitnesses.emplace_back(i, static_cast<double>((i * 5) % 16));
+	}
+	std::vector<std::pair<int,int>> selections = Select(fitnesses, generator, 16);
+	Population next = Crossover(selections, {}, generator, 16, pop, 50);
+	for (const auto& member : next.mMembers)
+	{
+		RequirePermutation(member);
+	}
+
+	// The same seed gives the same population
+	Xoshiro256StarStar again(1337);
+	REQUIRE(FillInitialPopulation(16, again, 12).mMembers == pop.mMembers);
+}
+
+TEST_CASE("Stochastic universal sampling", "[student]")
+{
+	std::mt19937 generator(5741328);
+	std::vector<std::pair<int,double>> fitnesses;
+	for (int i = 0; i < 100; i++)
+	{
+		fitnesses.emplace_back(i, static_cast<double>((i * 71) % 100));
+	}
+	std::vector<std::pair<int,double>> ranked = fitnesses;
+	std::vector<double> probabilities = RankProbabilities(ranked, 100, RankingMode::FullSort);
+	std::vector<std::pair<int,int>> selections = SelectUniversal(fitnesses, generator, 100, RankingMode::FullSort);
+	REQUIRE(selections.size() == 100);
+
+	// Every member gets its expected number of pointers, rounded up or down
+	std::vector<int> counts(100, 0);
+	for (const auto& parents : selections)
+	{
+		++counts[parents.first];
+		++counts[parents.second];
+	}
+	for (int i = 0; i < 100; i++)
+	{
+		double expected = probabilities[i] * 200.0;
+		REQUIRE(counts[i] >= std::floor(expected) - 1e-9);
+		REQUIRE(counts[i] <= std::ceil(expected) + 1e-9);
+	}
+
+	// The pairs are not tied to the order of the table: the low-index members that hold its first half of the mass
+	// also mate with each other
+	std::vector<double> cumulative(100);
+	std::partial_sum(probabilities.begin(), probabilities.end(), cumulative.begin());
+	int half = static_cast<int>(std::lower_bound(cumulative.begin(), cumulative.end(), 0.5) - cumulative.begin());
+	int lowPairs = 0;
+	for (const auto& parents : selections)
+	{
+		if (parents.first < half && parents.second < half)
+		{
+			++lowPairs;
+		}
+	}
+	REQUIRE(lowPairs > 0);
+}
+
+TEST_CASE("Permutation crossover operators", "[student]")
+{
+	const std::vector<int> first = { 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+	const std::vector<int> second = { 0, 8, 5, 2, 7, 1, 3, 6, 4 };
+	CrossoverScratch scratch;
+	std::vector<int> child;
+
+	SECTION("Splice")
+	{
+		SpliceCrossover(first, second, 3, scratch, child);
+		REQUIRE(child == std::vector<int>{ 0, 1, 2, 3, 8, 5, 7, 6, 4 });
+	}
+	SECTION("Order crossover")
+	{
+		// Identical parents give the parent back
+		OrderCrossover(second, second, 2, 4, scratch, child);
+		REQUIRE(child == second);
+		OrderCrossover(first, second, 3, 5, scratch, child);
+		REQUIRE(child == std::vector<int>{ 0, 8, 3, 4, 5, 2, 7, 1, 6 });
+		OrderCrossover(second, first, 2, 6, scratch, child);
+		REQUIRE(child == std::vector<int>{ 0, 5, 2, 7, 1, 3, 4, 6, 8 });
+	}
+	SECTION("Partially mapped crossover")
+	{
+		PartiallyMappedCrossover(first, second, 3, 5, scratch, child);
+		REQUIRE(child == std::vector<int>{ 0, 8, 1, 3, 4, 5, 2, 6, 7 });
+	}
+	SECTION("Children are tours that start at location 0")
+	{
+		std::mt19937 generator(49328573);
+		Population pop = FillInitialPopulation(2, generator, 50);
+		std::uniform_int_distribution<int> cut(1, 49);
+		for (int i = 0; i < 200; i++)
+		{
+			int begin = cut(generator);
+			int end = cut(generator);
+			if (begin > end)
+			{
+				std::swap(begin, end);
+			}
+			for (int op = 0; op < 2; op++)
+			{
+				if (op == 0)
+				{
+					OrderCrossover(pop.mMembers[0], pop.mMembers[1], begin, end, scratch, child);
+				}
+				else
+				{
+					PartiallyMappedCrossover(pop.mMembers[0], pop.mMembers[1], begin, end, scratch, child);
+				}
+				REQUIRE(child[0] == 0);
+				// The kept segment is still contiguous (OX1 may rotate it)
+				auto segment = std::find(child.begin(), child.end(), pop.mMembers[0][begin]);
+				REQUIRE(static_cast<int>(child.end() - segment) > end - begin);
+				REQUIRE(std::equal(pop.mMembers[0].begin() + begin, pop.mMembers[0].begin() + end + 1, segment));
+				RequirePermutation(child);
+			}
+		}
+	}
+}
+
+TEST_CASE("Edge assembly crossover", "[student]")
+{
+	std::mt19937 generator(12165465);
+	std::vector<Location> locations = RandomLocations(300, generator);
+	DistanceStore distances(locations);
+	distances.BuildCandidates(8);
+	Population pop = FillInitialPopulation(10, generator, locations.size());
+
+	EaxScratch scratch;
+	std::vector<int> child;
+	for (EaxStrategy strategy : { EaxStrategy::Random, EaxStrategy::Single })
+	{
+		for (int i = 0; i < 9; i++)
+		{
+			EdgeAssemblyCrossover(pop.mMembers[i], pop.mMembers[i + 1], distances, strategy, i, scratch, child);
+			REQUIRE(child[0] == 0);
+			RequirePermutation(child);
+		}
+	}
+
+	// Identical parents give the parent back
+	EdgeAssemblyCrossover(pop.mMembers[0], pop.mMembers[0], distances, EaxStrategy::Random, 1, scratch, child);
+	REQUIRE(child == pop.mMembers[0]);
+}
+
+TEST_CASE("Greedy crossover", "[student]")
+{
+	// Six locations on a north-south line, in index order
+	std::vector<Location> locations(6);
+	for (int i = 0; i < 6; i++)
+	{
+		locations[i].mLatitude = 34.0 + 0.01 * i;
+		locations[i].mLongitude = -118.0;
+	}
+	DistanceStore distances(locations);
+	CrossoverScratch scratch;
+	std::vector<int> child;
+
+	// From 0 the successors are 1 and 5, so the child takes 1; from 1 they are 2 and 4, so it takes 2; from 2 they are
+	// 5 and 3, so it takes 3. Both successors of 3 lead back to 0, so the next unused city of the first parent fills in
+	GreedyCrossover({ 0, 1, 2, 5, 4, 3 }, { 0, 5, 4, 1, 2, 3 }, distances, scratch, child);
+	REQUIRE(child == std::vector<int>{ 0, 1, 2, 3, 5, 4 });
+
+	// Identical parents give the parent back
+	GreedyCrossover({ 0, 2, 1, 4, 5, 3 }, { 0, 2, 1, 4, 5, 3 }, distances, scratch, child);
+	REQUIRE(child == std::vector<int>{ 0, 2, 1, 4, 5, 3 });
+	GreedyCrossover({ 0, 3, 1, 2, 5, 4 }, { 0, 4, 1, 5, 3, 2 }, distances, scratch, child);
+	RequirePermutation(child);
+	REQUIRE(child[0] == 0);
+}
+
+TEST_CASE("Inversion mutation", "[student]")
+{
+	std::mt19937 generator(5550123);
+	std::vector<Location> locations = RandomLocations(40, generator);
+	DistanceStore distances(locations);
+	std::vector<int> tour = FillInitialPopulation(1, generator, locations.size()).mMembers[0];
+
+	// The O(1) delta matches a full recomputation, including the whole tour after location 0 and a single gene
+	double length = distances.TourLength(tour);
+	std::uniform_int_distribution<int> index(1, 39);
+	for (int step = 0; step < 200; step++)
+	{
+		int begin = index(generator);
+		int end = index(generator);
+		if (step == 0)
+		{
+			begin = 1;
+			end = 39;
+		}
+		if (begin > end)
+		{
+			std::swap(begin, end);
+		}
+		length += InversionDelta(tour, begin, end, distances);
+		InversionMutation(tour, begin, end);
+		REQUIRE(length == Approx(distances.TourLength(tour)));
+		REQUIRE(tour[0] == 0);
+	}
+
+	// Children of identical parents differ from them in at most two edges under inversion
+	Population pop;
+	pop.mMembers.assign(8, tour);
+	std::vector<std::pair<int,int>> selections(8, { 0, 1 });
+	Population children = Crossover(selections, locations, generator, 8, pop, 100, CrossoverMode::Splice, nullptr, MutationMode::Inversion);
+	std::vector<int> successor(40);
+	for (int i = 0; i < 40; i++)
+	{
+		successor[tour[i]] = tour[(i + 1) % 40];
+	}
+	for (const auto& child : children.mMembers)
+	{
+		REQUIRE(child[0] == 0);
+		int changed = 0;
+		for (int i = 0; i < 40; i++)
+		{
+			int a = child[i];
+			int b = child[(i + 1) % 40];
+			if (successor[a] != b && successor[b] != a)
+			{
+				++changed;
+			}
+		}
+		REQUIRE(changed <= 2);
+	}
+}
+
+TEST_CASE("Adaptive mutation", "[student]")
+{
+	std::mt19937 generator(77123);
+	DiversityScratch scratch;
+
+	// A random population is as varied as it gets
+	Population varied = FillInitialPopulation(20, generator, 200);
+	DiversityMetrics metrics = MeasureDiversity(varied, scratch);
+	REQUIRE(metrics.mUniqueTours == 20);
+	REQUIRE(metrics.mEdgeDiversity > 0.9);
+	REQUIRE(metrics.mSharedEdges == 0.0);
+
+	// Copies of one tour, some of them read backwards, are a single tour with a single set of edges
+	Population converged;
+	std::vector<int> tour = varied.mMembers[0];
+	std::vector<int> backwards = tour;
+	std::reverse(backwards.begin() + 1, backwards.end());
+	for (int i = 0; i < 20; i++)
+	{
+		converged.mMembers.push_back(i % 2 == 0 ? tour : backwards);
+	}
+	metrics = MeasureDiversity(converged, scratch);
+	REQUIRE(metrics.mUniqueTours == 1);
+	REQUIRE(metrics.mDistinctEdges == 200);
+	REQUIRE(metrics.mEdgeDiversity == 0.0);
+	REQUIRE(metrics.mSharedEdges == 1.0);
+
+	// The chance goes up for the converged population and down for the varied one, within the bounds
+	GAOptions options;
+	options.mMutationMin = 5;
+	options.mMutationMax = 40;
+	DiversityMetrics low = MeasureDiversity(converged, scratch);
+	DiversityMetrics high = MeasureDiversity(varied, scratch);
+	REQUIRE(AdaptMutationChance(low, 20, 20, options) == 25);
+	REQUIRE(AdaptMutationChance(low, 20, 38, options) == 40);
+	REQUIRE(AdaptMutationChance(high, 20, 20, options) == 16);
+	REQUIRE(AdaptMutationChance(high, 20, 5, options) == 5);
+}
+
+TEST_CASE("2-opt local search", "[student]")
+{
+	// The corners of a square, visited so that the two diagonals cross
+	std::vector<Location> square(4);
+	square[1].mLatitude = 1.0;
+	square[2].mLongitude = 1.0;
+	square[3].mLatitude = 1.0;
+	square[3].mLongitude = 1.0;
+	DistanceStore squareDistances(square);
+	squareDistances.BuildCandidates(3);
+	LocalSearchScratch scratch;
+	std::vector<int> crossed = { 0, 3, 1, 2 };
+	REQUIRE(TwoOpt(crossed, squareDistances, 0, scratch) == 1);
+	REQUIRE(crossed[0] == 0);
+	REQUIRE(squareDistances.TourLength(crossed) < squareDistances.TourLength({ 0, 3, 1, 2 }));
+
+	// A random tour gets shorter, stays a permutation starting at location 0, and ends in a local optimum
+	std::mt19937 generator(331988960);
+	std::vector<Location> locations = RandomLocations(200, generator);
+	DistanceStore distances(locations);
+	distances.BuildCandidates(8);
+	std::vector<int> tour = FillInitialPopulation(1, generator, locations.size()).mMembers[0];
+	double before = distances.TourLength(tour);
+
+	std::vector<int> limited = tour;
+	REQUIRE(TwoOpt(limited, distances, 5, scratch) == 5);
+	REQUIRE(TwoOpt(tour, distances, 0, scratch) > 5);
+	REQUIRE(distances.TourLength(tour) < distances.TourLength(limited));
+	REQUIRE(distances.TourLength(limited) < before);
+	REQUIRE(TwoOpt(tour, distances, 0, scratch) == 0);
+	REQUIRE(tour[0] == 0);
+	RequirePermutation(tour);
+
+	// The memetic stage spends exactly its budget on random children, also when the budget is smaller than their number
+	// or does not divide evenly between them
+	GAOptions options;
+	options.mLocalSearch = LocalSearchMode::TwoOpt;
+	ThreadPool pool(3);
+	for (int budget : { 7, 20, 45 })
+	{
+		options.mLocalSearchBudget = budget;
+		Population children = FillInitialPopulation(20, generator, locations.size());
+		REQUIRE(ImproveChildren(children, distances, options, pool) == budget);
+	}
+}
+
+TEST_CASE("Or-opt local search", "[student]")
+{
+	// Eight locations on a north-south line, in index order; the best round trip visits them in order
+	std::vector<Location> line(8);
+	for (int i = 0; i < 8; i++)
+	{
+		line[i].mLatitude = 34.0 + 0.01 * i;
+		line[i].mLongitude = -118.0;
+	}
+	DistanceStore lineDistances(line);
+	lineDistances.BuildCandidates(4);
+	LocalSearchScratch scratch;
+
+	// Moving single cities and short segments fixes these tours (any tour that runs out along the line and back is as short)
+	std::vector<int> tour = { 0, 1, 2, 5, 3, 4, 6, 7 };
+	REQUIRE(OrOpt(tour, lineDistances, 0, scratch) >= 1);
+	REQUIRE(lineDistances.TourLength(tour) == Approx(2 * lineDistances.Get(0, 7)));
+	tour = { 0, 1, 6, 7, 2, 3, 4, 5 };
+	REQUIRE(OrOpt(tour, lineDistances, 0, scratch) >= 1);
+	REQUIRE(lineDistances.TourLength(tour) == Approx(2 * lineDistances.Get(0, 7)));
+
+	// A random tour gets shorter, stays a permutation starting at location 0, and ends in a local optimum
+	std::mt19937 generator(7410785);
+	std::vector<Location> locations = RandomLocations(200, generator);
+	DistanceStore distances(locations);
+	distances.BuildCandidates(8);
+	tour = FillInitialPopulation(1, generator, locations.size()).mMembers[0];
+	double before = distances.TourLength(tour);
+	REQUIRE(OrOpt(tour, distances, 0, scratch) > 0);
+	REQUIRE(distances.TourLength(tour) < before);
+	REQUIRE(OrOpt(tour, distances, 0, scratch) == 0);
+	REQUIRE(tour[0] == 0);
+	RequirePermutation(tour);
+
+	// With 2-opt as well, the tour is a local optimum for both moves
+	REQUIRE(TwoOptOrOpt(tour, distances, 0, scratch) > 0);
+	REQUIRE(TwoOpt(tour, distances, 0, scratch) == 0);
+	REQUIRE(OrOpt(tour, distances, 0, scratch) == 0);
+}
+
+TEST_CASE("Lin-Kernighan search", "[student]")
+{
+	std::mt19937 generator(49328573);
+	std::vector<Location> locations = RandomLocations(300, generator);
+	DistanceStore distances(locations);
+	distances.BuildCandidates(10);
+	Population pop = FillInitialPopulation(4, generator, locations.size());
+
+	// Deeper moves find a shorter tour than 2-opt and Or-opt from the same start
+	LocalSearchScratch scratch;
+	std::vector<int> tour = pop.mMembers[0];
+	std::vector<int> shallow = pop.mMembers[0];
+	REQUIRE(LinKernighan(tour, distances, 0, scratch) > 0);
+	TwoOptOrOpt(shallow, distances, 0, scratch);
+	REQUIRE(distances.TourLength(tour) < distances.TourLength(shallow));
+	REQUIRE(tour[0] == 0);
+	RequirePermutation(tour);
+
+	// Polishing a population runs the same search on every member, whatever the thread count
+	ThreadPool pool(3);
+	Population polished = pop;
+	PolishTours(polished, distances, pool);
+	REQUIRE(polished.mMembers[0] == tour);
+	for (size_t i = 0; i < pop.mMembers.size(); i++)
+	{
+		REQUIRE(distances.TourLength(polished.mMembers[i]) < distances.TourLength(pop.mMembers[i]));
+	}
+
+	// Every move it counts really shortens the tour, also on the two-level list, whose reversals may turn the tour around
+	// while a chain is undone (this instance used to cycle forever): the search ends well before its move limit
+	std::mt19937 manyGenerator(6);
+	std::vector<Location> many = RandomLocations(1000, manyGenerator);
+	DistanceStore manyDistances(many);
+	manyDistances.BuildCandidates(8);
+	std::vector<int> manyTour = FillInitialPopulation(1, manyGenerator, many.size()).mMembers[0];
+	for (int round = 0; round < 3; round++)
+	{
+		double before = manyDistances.TourLength(manyTour);
+		int moves = LinKernighan(manyTour, manyDistances, 5000, scratch);
+		REQUIRE(moves < 5000);
+		REQUIRE(manyDistances.TourLength(manyTour) <= before - moves * 1e-9);
+	}
+	REQUIRE(LinKernighan(manyTour, manyDistances, 5000, scratch) == 0);
+	RequirePermutation(manyTour);
+
+	// Started from active cities, the search only looks where they lead: nothing at all from none, somewhere from a few,
+	// and the same as the full search once every city is active in tour order
+	std::vector<int> activeTour = pop.mMembers[1];
+	REQUIRE(LinKernighan(activeTour, distances, std::vector<int>(), 0, scratch) == 0);
+	REQUIRE(activeTour == pop.mMembers[1]);
+	REQUIRE(LinKernighan(activeTour, distances, std::vector<int>(pop.mMembers[1].begin(), pop.mMembers[1].begin() + 20), 0, scratch) > 0);
+	REQUIRE(distances.TourLength(activeTour) < distances.TourLength(pop.mMembers[1]));
+	RequirePermutation(activeTour);
+	std::vector<int> fullTour = pop.mMembers[1];
+	LinKernighan(fullTour, distances, 0, scratch);
+	activeTour = pop.mMembers[1];
+	LinKernighan(activeTour, distances, pop.mMembers[1], 0, scratch);
+	REQUIRE(activeTour == fullTour);
+}
+
+TEST_CASE("Two-level list tour", "[student]")
+{
+	std::mt19937 generator(1836552);
+	const int size = 500;
+	Population pop = FillInitialPopulation(1, generator, size);
+	std::vector<int> reference = pop.mMembers[0];
+	TwoLevelTour list;
+	list.Assign(reference);
+
+	// Random reversals agree with reversing the same path of the array, up to the direction the list reads in
+	std::uniform_int_distribution<int> city(0, size - 1);
+	std::vector<int> positions(size);
+	for (int step = 0; step < 2000; step++)
+	{
+		for (int i = 0; i < size; i++)
+		{
+			positions[reference[i]] = i;
+		}
+		int a = city(generator);
+		int b = city(generator);
+		int c = city(generator);
+		bool between = (positions[b] - positions[a] + size) % size <= (positions[c] - positions[a] + size) % size;
+		REQUIRE(list.Between(a, b, c) == between);
+
+		int from = city(generator);
+		int to = city(generator);
+		list.Reverse(from, to);
+		int begin = positions[from];
+		int length = (positions[to] - begin + size) % size + 1;
+		for (int k = 0; k < length / 2; k++)
+		{
+			std::swap(reference[(begin + k) % size], reference[(begin + length - 1 - k) % size]);
+		}
+		int zero = static_cast<int>(std::find(reference.begin(), reference.end(), 0) - reference.begin());
+		if (list.Next(0) != reference[(zero + 1) % size])
+		{
+			std::reverse(reference.begin(), reference.end());
+		}
+		for (int i = 0; i < size; i++)
+		{
+			REQUIRE(list.Next(reference[i]) == reference[(i + 1) % size]);
+			REQUIRE(list.Prev(reference[(i + 1) % size]) == reference[i]);
+		}
+	}
+	std::vector<int> flat;
+	list.ToVector(flat);
+	std::rotate(reference.begin(), std::find(reference.begin(), reference.end(), 0), reference.end());
+	REQUIRE(flat == reference);
+
+	// The local search runs on the list as well and still returns a tour that starts at location 0
+	std::vector<Location> locations = RandomLocations(size, generator);
+	DistanceStore distances(locations);
+	distances.BuildCandidates(8);
+	LocalSearchScratch scratch;
+	scratch.mTwoLevelFrom = 0;
+	std::vector<int> tour = pop.mMembers[0];
+	REQUIRE(LinKernighan(tour, distances, 0, scratch) > 0);
+	REQUIRE(tour[0] == 0);
+	REQUIRE(distances.TourLength(tour) < distances.TourLength(pop.mMembers[0]));
+	RequirePermutation(tour);
+}
+
+TEST_CASE("Seeded initial population", "[student]")
+{
+	// Locations on a north-south line, shuffled; the greedy edges join the neighbors along the line
+	std::mt19937 generator(5517301);
+	std::vector<int> order(30);
+	std::iota(order.begin(), order.end(), 0);
+	std::shuffle(order.begin(), order.end(), generator);
+	std::vector<Location> line(30);
+	for (int i = 0; i < 30; i++)
+	{
+		line[order[i]].mLatitude = 34.0 + 0.01 * i;
+		line[order[i]].mLongitude = -118.0;
+	}
+	DistanceStore lineDistances(line);
+	lineDistances.BuildCandidates(4);
+	ConstructionScratch scratch;
+	std::vector<int> tour;
+	GreedyEdgeTour(lineDistances, 0.0, 0, scratch, tour);
+	REQUIRE(tour[0] == 0);
+	REQUIRE(lineDistances.TourLength(tour) == Approx(2 * lineDistances.Get(order[0], order[29])));
+
+	// Both constructions make permutations that start at location 0, far shorter than random tours
+	std::vector<Location> locations = RandomLocations(300, generator);
+	DistanceStore distances(locations);
+	distances.BuildCandidates(8);
+	Population random = FillInitialPopulation(1, generator, locations.size());
+	for (int mode = 0; mode < 3; mode++)
+	{
+		if (mode == 0)
+		{
+			NearestNeighborTour(distances, 123, scratch, tour);
+		}
+		else
+		{
+			GreedyEdgeTour(distances, mode == 1 ? 0.0 : 0.1, 42, scratch, tour);
+		}
+		REQUIRE(tour[0] == 0);
+		REQUIRE(distances.TourLength(tour) < 0.5 * distances.TourLength(random.mMembers[0]));
+		RequirePermutation(tour);
+	}
+
+	// Seeding replaces only the first quarter of the members, and leaves the others as they were drawn
+	for (SeedingMode seeding : { SeedingMode::NearestNeighbor, SeedingMode::GreedyEdge })
+	{
+		std::mt19937 first(9001);
+		std::mt19937 second(9001);
+		Population unseeded = FillInitialPopulation(8, first, locations.size());
+		Population seeded = FillInitialPopulation(8, second, locations.size());
+		SeedInitialPopulation(seeded, second, distances, seeding, 0.25);
+		for (int i = 0; i < 8; i++)
+		{
+			REQUIRE((seeded.mMembers[i] == unseeded.mMembers[i]) == (i >= 2));
+			REQUIRE(seeded.mMembers[i][0] == 0);
+		}
+		REQUIRE(seeded.mMembers[0] != seeded.mMembers[1]);
+	}
+}
+
+TEST_CASE("Hilbert curve tours", "[student]")
+{
+	// On a 16 by 16 grid the curve steps from every point to a grid neighbor
+	std::vector<ProjectedPoint> grid;
+	for (int x = 0; x < 16; x++)
+	{
+		for (int y = 0; y < 16; y++)
+		{
+			grid.push_back({ static_cast<double>(x), static_cast<double>(y) });
+		}
+	}
+	ConstructionScratch scratch;
+	std::vector<int> tour;
+	HilbertTour(grid, 0.0, 0, scratch, tour);
+	REQUIRE(tour.size() == 256);
+	REQUIRE(tour[0] == 0);
+	for (size_t i = 1; i < tour.size(); i++)
+	{
+		const ProjectedPoint& a = grid[tour[i - 1]];
+		const ProjectedPoint& b = grid[tour[i]];
+		REQUIRE(std::abs(a.mX - b.mX) + std::abs(a.mY - b.mY) == 1.0);
+	}
+
+	// The initial population: permutations starting at location 0, the shifted ones different from each other, and all
+	// far shorter than random tours
+	std::mt19937 generator(2718281);
+	std::vector<Location> locations = RandomLocations(500, generator);
+	DistanceStore distances(locations);
+	Population random = FillInitialPopulation(1, generator, locations.size());
+	Population pop = FillInitialPopulation(6, generator, locations, distances, InitialTourMode::Hilbert);
+	REQUIRE(pop.mMembers.size() == 6);
+	std::vector<int> plain;
+	HilbertTour(ProjectLocations(locations), 0.0, 0, scratch, plain);
+	REQUIRE(pop.mMembers[0] == plain);
+	for (size_t i = 0; i < pop.mMembers.size(); i++)
+	{
+		REQUIRE(pop.mMembers[i][0] == 0);
+		REQUIRE(distances.TourLength(pop.mMembers[i]) < 0.2 * distances.TourLength(random.mMembers[0]));
+		RequirePermutation(pop.mMembers[i]);
+		for (size_t j = 0; j < i; j++)
+		{
+			REQUIRE(pop.mMembers[i] != pop.mMembers[j]);
+		}
+	}
+
+	// The shuffle is the plain overload
+	std::mt19937 first(31337);
+	std::mt19937 second(31337);
+	REQUIRE(FillInitialPopulation(5, first, locations, distances, InitialTourMode::Shuffle).mMembers == FillInitialPopulation(5, second, locations.size()).mMembers);
+}
+
+TEST_CASE("Construction heuristics", "[student]")
+{
+	ConstructionScratch scratch;
+	std::vector<int> tour;
+
+	// Points on a circle, shuffled: the hull is the whole tour
+	std::mt19937 generator(8675309);
+	std::vector<Location> circle(40);
+	for (int i = 0; i < 40; i++)
+	{
+		circle[i].mLatitude = 34.0 + 0.1 * std::sin(0.157 * i);
+		circle[i].mLongitude = -118.0 + 0.1 * std::cos(0.157 * i) / std::cos(34.0 * 0.0174533);
+	}
+	DistanceStore circleDistances(circle);
+	circleDistances.BuildCandidates(5);
+	std::vector<int> around(40);
+	std::iota(around.begin(), around.end(), 0);
+	ConvexHullInsertionTour(circleDistances, ProjectLocations(circle), 0.0, 0, scratch, tour);
+	REQUIRE(circleDistances.TourLength(tour) == Approx(circleDistances.TourLength(around)));
+
+	// Two clusters far apart, whose candidate lists never reach the other cluster, and a larger random instance
+	std::uniform_real_distribution<double> coordinate(0.0, 1.0);
+	std::vector<Location> clusters(60);
+	for (int i = 0; i < 60; i++)
+	{
+		clusters[i].mLatitude = (i % 2 == 0 ? 34.0 : 40.0) + 0.1 * coordinate(generator);
+		clusters[i].mLongitude = (i % 2 == 0 ? -118.0 : -75.0) + 0.1 * coordinate(generator);
+	}
+	std::vector<Location> locations = RandomLocations(400, generator);
+	for (const std::vector<Location>* instance : { &clusters, &locations })
+	{
+		DistanceStore distances(*instance);
+		distances.BuildCandidates(instance == &clusters ? 4 : 8);
+		std::vector<ProjectedPoint> points = ProjectLocations(*instance);
+		NearestNeighborTour(distances, 0, scratch, tour);
+		double reference = distances.TourLength(tour);
+		for (int method = 0; method < 4; method++)
+		{
+			for (double noise : { 0.0, 0.1 })
+			{
+				switch (method)
+				{
+				case 0: CheapestInsertionTour(distances, noise, 7, scratch, tour); break;
+				case 1: FarthestInsertionTour(distances, points, noise, 7, scratch, tour); break;
+				case 2: ConvexHullInsertionTour(distances, points, noise, 7, scratch, tour); break;
+				default: ChristofidesTour(distances, noise, 7, scratch, tour); break;
+				}
+				REQUIRE(tour.size() == instance->size());
+				REQUIRE(tour[0] == 0);
+				REQUIRE(distances.TourLength(tour) < 1.2 * reference);
+				RequirePermutation(tour);
+			}
+		}
+	}
+
+	// Location 0 inside a cluster in the middle of three far away ones: the hull tour starts without it, and no candidate
+	// list of the middle cluster reaches the tour
+	std::vector<Location> inside(80);
+	const double centers[4][2] = { { 36.0, -100.0 }, { 33.0, -110.0 }, { 33.0, -90.0 }, { 41.0, -100.0 } };
+	for (int i = 0; i < 80; i++)
+	{
+		inside[i].mLatitude = centers[i % 4][0] + (i == 0 ? 0.05 : 0.1 * coordinate(generator));
+		inside[i].mLongitude = centers[i % 4][1] + (i == 0 ? 0.05 : 0.1 * coordinate(generator));
+	}
+	DistanceStore insideDistances(inside);
+	insideDistances.BuildCandidates(4);
+	for (double noise : { 0.0, 0.1 })
+	{
+		ConvexHullInsertionTour(insideDistances, ProjectLocations(inside), noise, 7, scratch, tour);
+		REQUIRE(tour[0] == 0);
+		RequirePermutation(tour);
+		REQUIRE(tour.size() == 80);
+	}
+
+	// As initial population: the plain tour first, then different noisy ones
+	DistanceStore distances(locations);
+	distances.BuildCandidates(8);
+	Population pop = FillInitialPopulation(4, generator, locations, distances, InitialTourMode::Christofides);
+	ChristofidesTour(distances, 0.0, 0, scratch, tour);
+	REQUIRE(pop.mMembers[0] == tour);
+	REQUIRE(pop.mMembers[1] != pop.mMembers[0]);
+	REQUIRE(pop.mMembers[2] != pop.mMembers[1]);
+}
+
+TEST_CASE("Parallel initial population", "[student]")
+{
+	std::mt19937 generator(1618033);
+	std::vector<Location> locations = RandomLocations(300, generator);
+	DistanceStore distances(locations);
+	distances.BuildCandidates(8);
+
+	// The same population for any thread count, made of different permutations that start at location 0
+	for (InitialTourMode mode : { InitialTourMode::Shuffle, InitialTourMode::Hilbert, InitialTourMode::CheapestInsertion })
+	{
+		ThreadPool single(1);
+		Population reference = ParallelFillInitialPopulation(13, 4242, locations, distances, mode, single);
+		REQUIRE(reference.mMembers.size() == 13);
+		for (int threads : { 2, 3, 5 })
+		{
+			ThreadPool pool(threads);
+			REQUIRE(ParallelFillInitialPopulation(13, 4242, locations, distances, mode, pool).mMembers == reference.mMembers);
+		}
+		for (size_t i = 0; i < reference.mMembers.size(); i++)
+		{
+			REQUIRE(reference.mMembers[i][0] == 0);
+			RequirePermutation(reference.mMembers[i]);
+			for (size_t j = 0; j < i; j++)
+			{
+				REQUIRE(reference.mMembers[i] != reference.mMembers[j]);
+			}
+		}
+		ThreadPool pool(2);
+		REQUIRE(ParallelFillInitialPopulation(13, 4243, locations, distances, mode, pool).mMembers[1] != reference.mMembers[1]);
+	}
+}
+
+TEST_CASE("KD-tree spatial index", "[student]")
+{
+	std::mt19937 generator(14142135);
+	std::uniform_real_distribution<double> coordinate(0.0, 1.0);
+	std::vector<Location> locations(3000);
+	for (size_t i = 0; i < locations.size(); i++)
+	{
+		// A few locations share their coordinates with another one
+		if (i % 500 == 499)
+		{
+			locations[i] = locations[i - 1];
+			continue;
+		}
+		locations[i].mLatitude = 34.0 + coordinate(generator);
+		locations[i].mLongitude = -118.0 + coordinate(generator);
+	}
+	DistanceStore distances(locations);
+	const KdTree& tree = distances.Tree();
+	REQUIRE(tree.Size() == 3000);
+
+	// Nearest neighbors and radius queries agree with scanning every location
+	std::uniform_int_distribution<int> city(0, 2999);
+	std::vector<std::pair<double,int>> nearest;
+	std::vector<int> within;
+	std::vector<double> scanned;
+	for (int query = 0; query < 100; query++)
+	{
+		int from = city(generator);
+		scanned.clear();
+		for (int other = 0; other < 3000; other++)
+		{
+			if (other != from)
+			{
+				scanned.push_back(distances.Get(from, other));
+			}
+		}
+		std::sort(scanned.begin(), scanned.end());
+		tree.Nearest(from, 12, nearest);
+		REQUIRE(nearest.size() == 12);
+		for (int i = 0; i < 12; i++)
+		{
+			REQUIRE(distances.Get(from, nearest[i].second) == Approx(scanned[i]).margin(1e-9));
+		}
+
+		double miles = 2.0;
+		tree.WithinRadius(from, miles, within);
+		size_t inside = std::upper_bound(scanned.begin(), scanned.end(), miles) - scanned.begin();
+		REQUIRE(within.size() == inside);
+		for (int other : within)
+		{
+			REQUIRE(distances.Get(from, other) <= miles + 1e-9);
+		}
+	}
+
+	// Nearest remaining location while the marks fill up, as in a nearest-neighbor tour
+	KdTreeMarks marks;
+	tree.ResetMarks(marks);
+	std::vector<char> removed(3000, 0);
+	int current = 0;
+	for (int step = 0; step < 2999; step++)
+	{
+		tree.Remove(current, marks);
+		removed[current] = 1;
+		int next = tree.NearestRemaining(current, marks);
+		REQUIRE(next >= 0);
+		REQUIRE(!removed[next]);
+		double best = -1.0;
+		for (int other = 0; other < 3000; other++)
+		{
+			if (!removed[other] && (best < 0 || distances.Get(current, other) < best))
+			{
+				best = distances.Get(current, other);
+			}
+		}
+		REQUIRE(distances.Get(current, next) == Approx(best).margin(1e-9));
+		current = next;
+	}
+	tree.Remove(current, marks);
+	REQUIRE(tree.NearestRemaining(current, marks) == -1);
+
+	// The candidate lists are the nearest neighbors
+	distances.BuildCandidates(6);
+	for (int from = 0; from < 3000; from += 97)
+	{
+		tree.Nearest(from, 6, nearest);
+		for (int i = 0; i < 6; i++)
+		{
+			REQUIRE(distances.Get(from, distances.Candidates(from)[i]) == Approx(distances.Get(from, nearest[i].second)).margin(1e-9));
+		}
+	}
+}
+
+TEST_CASE("Delaunay candidate edges", "[student]")
+{
+	// Random points: an edge is Delaunay exactly when some circle through its ends holds no other point, which is checked
+	// here on every triangle the edge can make
+	std::mt19937 generator(7071067);
+	std::uniform_real_distribution<double> coordinate(0.0, 1.0);
+	std::vector<ProjectedPoint> points(50);
+	for (auto& point : points)
+	{
+		point.mX = coordinate(generator);
+		point.mY = coordinate(generator);
+	}
+	auto inCircle = [&points](int a, int b, int c, int d) {
+		double ax = points[a].mX - points[d].mX, ay = points[a].mY - points[d].mY;
+		double bx = points[b].mX - points[d].mX, by = points[b].mY - points[d].mY;
+		double cx = points[c].mX - points[d].mX, cy = points[c].mY - points[d].mY;
+		double det = (ax * ax + ay * ay) * (bx * cy - cx * by) - (bx * bx + by * by) * (ax * cy - cx * ay) + (cx * cx + cy * cy) * (ax * by - bx * ay);
+		double orient = (points[b].mX - points[a].mX) * (points[c].mY - points[a].mY) - (points[b].mY - points[a].mY) * (points[c].mX - points[a].mX);
+		return orient > 0 ? det > 0 : det < 0;
+	};
+	std::vector<std::pair<int,int>> expected;
+	for (int a = 0; a < 50; a++)
+	{
+		for (int b = a + 1; b < 50; b++)
+		{
+			bool empty = false;
+			for (int c = 0; c < 50 && !empty; c++)
+			{
+				if (c == a || c == b)
+				{
+					continue;
+				}
+				empty = true;
+				for (int d = 0; d < 50 && empty; d++)
+				{
+					empty = d == a || d == b || d == c || !inCircle(a, b, c, d);
+				}
+			}
+			if (empty)
+			{
+				expected.emplace_back(a, b);
+			}
+		}
+	}
+	std::vector<std::pair<int,int>> edges;
+	DelaunayEdges(points, edges);
+	REQUIRE(edges == expected);
+
+	// A grid has many points on one circle; any triangulation of it has 3N - 3 - (points on the hull) edges, among them
+	// all the grid lines. A copy of a point gets an edge to it.
+	std::vector<ProjectedPoint> grid;
+	for (int x = 0; x < 5; x++)
+	{
+		for (int y = 0; y < 5; y++)
+		{
+			grid.push_back({ static_cast<double>(x), static_cast<double>(y) });
+		}
+	}
+	DelaunayEdges(grid, edges);
+	REQUIRE(edges.size() == 56);
+	for (int i = 0; i < 25; i++)
+	{
+		if (i % 5 < 4)
+		{
+			REQUIRE(std::binary_search(edges.begin(), edges.end(), std::make_pair(i, i + 1)));
+		}
+		if (i < 20)
+		{
+			REQUIRE(std::binary_search(edges.begin(), edges.end(), std::make_pair(i, i + 5)));
+		}
+	}
+	grid.push_back(grid[12]);
+	DelaunayEdges(grid, edges);
+	REQUIRE(std::binary_search(edges.begin(), edges.end(), std::make_pair(12, 25)));
+	REQUIRE(std::binary_search(edges.begin(), edges.end(), std::make_pair(7, 25)));
+
+	// Two clusters far apart: the nearest neighbors stay inside a cluster, the Delaunay lists also cross between them
+	std::vector<Location> clusters(100);
+	for (int i = 0; i < 100; i++)
+	{
+		clusters[i].mLatitude = 34.0 + 0.1 * coordinate(generator);
+		clusters[i].mLongitude = (i < 50 ? -118.0 : -117.0) + 0.1 * coordinate(generator);
+	}
+	DistanceStore distances(clusters);
+	for (CandidateSet set : { CandidateSet::Nearest, CandidateSet::Delaunay, CandidateSet::DelaunayQuadrant })
+	{
+		distances.BuildCandidates(6, set);
+		REQUIRE(distances.CandidateCount() == 6);
+		int crossing = 0;
+		for (int city = 0; city < 100; city++)
+		{
+			const int* candidates = distances.Candidates(city);
+			for (int i = 0; i < 6; i++)
+			{
+				REQUIRE(candidates[i] != city);
+				REQUIRE(std::count(candidates, candidates + 6, candidates[i]) == 1);
+				if (i > 0)
+				{
+					REQUIRE(distances.Get(city, candidates[i - 1]) <= distances.Get(city, candidates[i]));
+				}
+				crossing += (city < 50) != (candidates[i] < 50) ? 1 : 0;
+			}
+		}
+		REQUIRE((crossing > 0) == (set != CandidateSet::Nearest));
+	}
+}
+
+TEST_CASE("Cluster decomposition", "[student]")
+{
+	std::mt19937 generator(2718281);
+	std::vector<Location> locations = RandomLocations(1500, generator);
+
+	// Every location in exactly one cluster of 100 to 200 cities
+	std::vector<std::vector<int>> clusters = ClusterLocations(ProjectLocations(locations), 200);
+	REQUIRE(clusters.size() == 8);
+	std::vector<int> seen(locations.size(), 0);
+	for (const auto& cluster : clusters)
+	{
+		REQUIRE(cluster.size() >= 100);
+		REQUIRE(cluster.size() <= 200);
+		for (int city : cluster)
+		{
+			seen[city]++;
+		}
+	}
+	REQUIRE(std::count(seen.begin(), seen.end(), 1) == 1500);
+	REQUIRE(ClusterLocations(ProjectLocations(locations), 2000).size() == 1);
+	REQUIRE_THROWS_AS(ClusterLocations(ProjectLocations(locations), 0), std::invalid_argument);
+
+	// A full tour from location 0, the same for any thread count, and well under a nearest neighbor tour
+	DistanceStore distances(locations);
+	distances.BuildCandidates(8);
+	GAOptions options;
+	options.mSolver = SolverMode::Clusters;
+	options.mClusterSize = 200;
+	options.mCrossover = CrossoverMode::Greedy;
+	options.mLocalSearch = LocalSearchMode::TwoOpt;
+	ThreadPool single(1);
+	std::vector<int> tour = SolveByClusters<std::mt19937>(locations, distances, 8, 5, 10, 1337, options, single);
+	REQUIRE(tour.size() == 1500);
+	REQUIRE(tour[0] == 0);
+	RequirePermutation(tour);
+	ThreadPool pool(3);
+	REQUIRE(SolveByClusters<std::mt19937>(locations, distances, 8, 5, 10, 1337, options, pool) == tour);
+
+	ConstructionScratch scratch;
+	std::vector<int> nearest;
+	NearestNeighborTour(distances, 0, scratch, nearest);
+	REQUIRE(distances.TourLength(tour) < 0.9 * distances.TourLength(nearest));
+
+	// The clusters are solved in the instance's own metric
+	std::vector<ProjectedPoint> coordinates(locations.size());
+	for (size_t i = 0; i < locations.size(); i++)
+	{
+		coordinates[i].mX = 1000.0 * (locations[i].mLongitude + 118.0);
+		coordinates[i].mY = 1000.0 * (locations[i].mLatitude - 34.0);
+	}
+	DistanceStore planar(locations, DistanceMetric::Euclidean, coordinates);
+	planar.BuildCandidates(8);
+	std::vector<int> planarTour = SolveByClusters<std::mt19937>(locations, planar, 8, 5, 10, 1337, options, single);
+	REQUIRE(planarTour[0] == 0);
+	RequirePermutation(planarTour);
+	NearestNeighborTour(planar, 0, scratch, nearest);
+	REQUIRE(planar.TourLength(planarTour) < 0.9 * planar.TourLength(nearest));
+}
+
+TEST_CASE("Location file parsing", "[student]")
+{
+	// Plain, CRLF and trailing newlines, blank lines, blanks and plus signs before the numbers, extra fields
+	std::vector<LocationRecord> records;
+	ParseLocations("LAX Airport,33.941845,-118.408635\r\nColiseum, +34.014,-118.287\n\nSanta Monica Pier,34.0082,-118.4988,pier\n\n", records);
+	REQUIRE(records.size() == 3);
+	REQUIRE(records[0].mName == "LAX Airport");
+	REQUIRE(records[0].mLatitude == 33.941845);
+	REQUIRE(records[0].mLongitude == -118.408635);
+	REQUIRE(records[1].mName == "Coliseum");
+	REQUIRE(records[1].mLatitude == 34.014);
+	REQUIRE(records[2].mName == "Santa Monica Pier");
+	REQUIRE(records[2].mLongitude == -118.4988);
+
+	// The same records without any line ending at the end, and with CRLF everywhere
+	std::vector<LocationRecord> again;
+	ParseLocations("LAX Airport,33.941845,-118.408635\r\nColiseum,34.014,-118.287\r\nSanta Monica Pier,34.0082,-118.4988", again);
+	REQUIRE(again.size() == 3);
+	REQUIRE(again[2].mLongitude == -118.4988);
+	again.clear();
+	ParseLocations("", again);
+	REQUIRE(again.empty());
+
+	REQUIRE_THROWS_AS(ParseLocations("LAX Airport,33.941845\n", records), std::invalid_argument);
+	REQUIRE_THROWS_AS(ParseLocations("LAX Airport,north,-118.408635\n", records), std::invalid_argument);
+	REQUIRE_THROWS_AS(ParseLocations("LAX Airport,33.941845,\r\n", records), std::invalid_argument);
+
+	// Reading a file with a trailing newline through the mapping
+	{
+		std::ofstream out("parse_test_locations.txt", std::ios::binary);
+		out << "LAX Airport,33.941845,-118.408635\r\nColiseum,34.014,-118.287\r\n";
+	}
+	std::vector<Location> locations = ReadLocations("parse_test_locations.txt");
+	std::remove("parse_test_locations.txt");
+	REQUIRE(locations.size() == 2);
+	REQUIRE(locations[1].mName == "Coliseum");
+	REQUIRE(locations[1].mLongitude == -118.287);
+	REQUIRE(ReadLocations("parse_test_missing.txt").empty());
+	MappedFile missing("parse_test_missing.txt");
+	REQUIRE(!missing.IsOpen());
+}
+
+TEST_CASE("Parallel location parsing", "[student]")
+{
+	// About 2 MB of lines with both line endings and blank lines, so chunk boundaries fall everywhere
+	std::mt19937 generator(141421);
+	std::uniform_real_distribution<double> coordinate(-90.0, 90.0);
+	std::string text;
+	for (int i = 0; i < 40000; i++)
+	{
+		text += "Stop " + std::to_string(i) + "," + std::to_string(coordinate(generator)) + "," + std::to_string(coordinate(generator));
+		text += i % 3 == 0 ? "\r\n" : (i % 7 == 0 ? "\n\n" : "\n");
+	}
+	REQUIRE(text.size() > (1 << 20));
+	std::vector<LocationRecord> serial;
+	ParseLocations(text, serial);
+	REQUIRE(serial.size() == 40000);
+
+	for (int threads : { 1, 2, 3, 7 })
+	{
+		ThreadPool pool(threads);
+		std::vector<std::vector<LocationRecord>> chunks;
+		ParallelParseLocations(text, pool, chunks);
+		REQUIRE(chunks.size() == static_cast<size_t>(threads));
+		size_t index = 0;
+		for (const auto& chunk : chunks)
+		{
+			for (const LocationRecord& record : chunk)
+			{
+				REQUIRE(record.mName == serial[index].mName);
+				REQUIRE(record.mLatitude == serial[index].mLatitude);
+				REQUIRE(record.mLongitude == serial[index].mLongitude);
+				index++;
+			}
+		}
+		REQUIRE(index == serial.size());
+	}
+
+	// A bad line reports the line number of the whole text, not of its chunk
+	std::string broken = text + "Nowhere,north,east\n";
+	std::string expected;
+	try
+	{
+		ParseLocations(broken, serial);
+	}
+	catch (const std::invalid_argument& error)
+	{
+		expected = error.what();
+	}
+	REQUIRE(!expected.empty());
+	ThreadPool pool(4);
+	std::vector<std::vector<LocationRecord>> chunks;
+	REQUIRE_THROWS_WITH(ParallelParseLocations(broken, pool, chunks), expected);
+
+	// The parallel reading gives the locations in the same order as the serial one
+	{
+		std::ofstream out("parallel_test_locations.txt", std::ios::binary);
+		out << text;
+	}
+	std::vector<Location> parallel = ReadLocations("parallel_test_locations.txt", pool);
+	std::vector<Location> locations = ReadLocations("parallel_test_locations.txt");
+	std::remove("parallel_test_locations.txt");
+	REQUIRE(parallel.size() == locations.size());
+	for (size_t i = 0; i < locations.size(); i++)
+	{
+		REQUIRE(parallel[i].mName == locations[i].mName);
+		REQUIRE(parallel[i].mLatitude == locations[i].mLatitude);
+	}
+}
+
+TEST_CASE("TSPLIB reader", "[student]")
+{
+	auto write = [](const char* fileName, const std::string& text) {
+		std::ofstream out(fileName, std::ios::binary);
+		out << text;
+	};
+
+	// burma14 (GEO), whose published optimum is 3323
+	write("tsplib_test_burma14.tsp", "NAME: burma14\nTYPE: TSP\nCOMMENT: 14-Staedte in Burma (Zaw Win)\nDIMENSION: 14\nEDGE_WEIGHT_TYPE: GEO\nEDGE_WEIGHT_FORMAT: FUNCTION\nDISPLAY_DATA_TYPE: COORD_DISPLAY\nNODE_COORD_SECTION\n"
+		"   1  16.47       96.10\n   2  16.47       94.44\n   3  20.09       92.54\n   4  22.39       93.37\n   5  25.23       97.24\n   6  22.00       96.05\n   7  20.47       97.02\n"
+		"   8  17.20       96.29\n   9  16.30       97.38\n  10  14.05       98.12\n  11  16.53       97.38\n  12  21.52       95.59\n  13  19.41       97.13\n  14  20.09       94.55\nEOF\n");
+	TspLibInstance burma = ReadTspLib("tsplib_test_burma14.tsp");
+	std::remove("tsplib_test_burma14.tsp");
+	REQUIRE(burma.mName == "burma14");
+	REQUIRE(burma.mMetric == DistanceMetric::Geographic);
+	REQUIRE(burma.mLocations.size() == 14);
+	REQUIRE(burma.mLocations[13].mName == "14");
+	REQUIRE(burma.mLocations[0].mLatitude == Approx(16.0 + 47.0 / 60.0));
+	DistanceStore burmaDistances = MakeDistanceStore(burma);
+	REQUIRE(burmaDistances.Metric() == DistanceMetric::Geographic);
+	std::vector<int> optimal = { 0, 1, 13, 2, 3, 4, 5, 11, 6, 12, 7, 10, 8, 9 };
+	REQUIRE(burmaDistances.TourLength(optimal) == 3323);
+	burmaDistances.BuildCandidates(6);
+	ConstructionScratch constructionScratch;
+	std::vector<int> tour;
+	NearestNeighborTour(burmaDistances, 0, constructionScratch, tour);
+	LocalSearchScratch scratch;
+	LinKernighan(tour, burmaDistances, 0, scratch);
+	REQUIRE(burmaDistances.TourLength(tour) >= 3323);
+	REQUIRE(burmaDistances.TourLength(tour) <= 3323 * 1.05);
+	Population pop;
+	pop.mMembers.push_back(optimal);
+	REQUIRE(computeFitnesses(pop, burmaDistances)[0].second == 3323);
+
+	// EUC_2D rounds to the nearest integer and ATT rounds up; both keep neighbors close on the placed locations
+	write("tsplib_test_square.tsp", "NAME : square\r\nTYPE : TSP\r\nDIMENSION : 4\r\nEDGE_WEIGHT_TYPE : EUC_2D\r\nNODE_COORD_SECTION\r\n1 0 0\r\n3 3.2 4\r\n2 3.2 0\r\n4 0 4e0\r\nEOF\r\n");
+	TspLibInstance square = ReadTspLib("tsplib_test_square.tsp");
+	std::remove("tsplib_test_square.tsp");
+	DistanceStore squareDistances = MakeDistanceStore(square);
+	REQUIRE(squareDistances.Get(0, 1) == 3);
+	REQUIRE(squareDistances.Get(1, 2) == 4);
+	REQUIRE(squareDistances.Get(0, 2) == 5);
+	REQUIRE(squareDistances.Get(3, 3) == 0);
+	write("tsplib_test_att.tsp", "NAME: att\nTYPE: TSP\nDIMENSION: 2\nEDGE_WEIGHT_TYPE: ATT\nNODE_COORD_SECTION\n1 0 0\n2 30 40\n");
+	TspLibInstance att = ReadTspLib("tsplib_test_att.tsp");
+	std::remove("tsplib_test_att.tsp");
+	REQUIRE(MakeDistanceStore(att).Get(0, 1) == 16); // sqrt(250) = 15.8 rounds to 16
+
+	// The same explicit matrix from every supported format, loaded without coordinates
+	const std::vector<std::pair<std::string, std::string>> formats = {
+		{ "FULL_MATRIX", "0 2 9 10\n2 0 6 4\n9 6 0 8\n10 4 8 0\n" },
+		{ "UPPER_ROW", "2 9 10\n6 4\n8\n" },
+		{ "LOWER_ROW", "2\n9 6\n10 4 8\n" },
+		{ "UPPER_DIAG_ROW", "0 2 9 10 0 6 4 0 8 0\n" },
+		{ "LOWER_DIAG_ROW", "0\n2 0\n9 6 0\n10 4 8 0\n" },
+	};
+	for (const auto& format : formats)
+	{
+		write("tsplib_test_explicit.tsp", "NAME: four\nTYPE: TSP\nDIMENSION: 4\nEDGE_WEIGHT_TYPE: EXPLICIT\nEDGE_WEIGHT_FORMAT: " + format.first + "\nEDGE_WEIGHT_SECTION\n" + format.second + "EOF\n");
+		TspLibInstance instance = ReadTspLib("tsplib_test_explicit.tsp");
+		std::remove("tsplib_test_explicit.tsp");
+		REQUIRE(instance.mMetric == DistanceMetric::Explicit);
+		DistanceStore distances = MakeDistanceStore(instance);
+		REQUIRE(distances.Get(0, 1) == 2);
+		REQUIRE(distances.Get(3, 0) == 10);
+		REQUIRE(distances.Get(2, 3) == 8);
+		REQUIRE(distances.Get(1, 3) == 4);
+		REQUIRE(distances.Get(2, 2) == 0);
+		distances.BuildCandidates(2, CandidateSet::Delaunay);
+		REQUIRE(distances.Candidates(0)[0] == 1);
+		REQUIRE(distances.Candidates(0)[1] == 2);
+		REQUIRE(distances.Candidates(3)[0] == 1);
+		REQUIRE(distances.TourLength({ 0, 1, 3, 2 }) == 23);
+
+		// Without display data the constructions fall back on the matrix, not on the placement at 0, 0
+		REQUIRE(!instance.mHasGeometry);
+		distances.BuildCandidates(1);
+		ConstructionScratch scratch;
+		std::vector<int> tour;
+		NearestNeighborTour(distances, 0, scratch, tour);
+		REQUIRE(tour == std::vector<int>{ 0, 1, 3, 2 });
+	}
+	write("tsplib_test_explicit.tsp", "NAME: four\nTYPE: TSP\nDIMENSION: 4\nEDGE_WEIGHT_TYPE: EXPLICIT\nEDGE_WEIGHT_FORMAT: UPPER_ROW\nEDGE_WEIGHT_SECTION\n2 9 10\n6 4\n8\nEOF\n");
+	const char* argv[] = { "tests/tests", "tsplib_test_explicit.tsp", "4", "1", "10", "1337", "--initial-tours=hilbert" };
+	REQUIRE_THROWS_AS(ProcessCommandArgs(7, argv), std::invalid_argument);
+	write("tsplib_test_explicit.tsp", "NAME: four\nTYPE: TSP\nDIMENSION: 4\nEDGE_WEIGHT_TYPE: EXPLICIT\nEDGE_WEIGHT_FORMAT: UPPER_ROW\nEDGE_WEIGHT_SECTION\n2 9 10\n6 4\n8\n"
+		"DISPLAY_DATA_SECTION\n1 0 0\n2 0 2\n3 6 2\n4 4 4\nEOF\n");
+	REQUIRE(ReadTspLib("tsplib_test_explicit.tsp").mHasGeometry);
+	std::remove("tsplib_test_explicit.tsp");
+
+	write("tsplib_test_bad.tsp", "NAME: bad\nTYPE: ATSP\nDIMENSION: 2\n");
+	REQUIRE_THROWS_AS(ReadTspLib("tsplib_test_bad.tsp"), std::invalid_argument);
+	write("tsplib_test_bad.tsp", "NAME: bad\nTYPE: TSP\nDIMENSION: 3\nEDGE_WEIGHT_TYPE: EUC_2D\nNODE_COORD_SECTION\n1 0 0\n2 1 1\nEOF\n");
+	REQUIRE_THROWS_AS(ReadTspLib("tsplib_test_bad.tsp"), std::invalid_argument);
+	write("tsplib_test_bad.tsp", "NAME: bad\nTYPE: TSP\nDIMENSION: 2\nEDGE_WEIGHT_TYPE: MAN_2D\nNODE_COORD_SECTION\n1 0 0\n2 1 1\nEOF\n");
+	REQUIRE_THROWS_AS(ReadTspLib("tsplib_test_bad.tsp"), std::invalid_argument);
+	std::remove("tsplib_test_bad.tsp");
+	REQUIRE_THROWS_AS(ReadTspLib("tsplib_test_missing.tsp"), std::invalid_argument);
+	REQUIRE(IsTspLibFile("input/burma14.tsp"));
+	REQUIRE(!IsTspLibFile("input/locations.txt"));
+}